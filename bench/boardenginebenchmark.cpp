@@ -0,0 +1,364 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "boardengine.h"
+#include "heuristic.h"
+#include "movekernel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+static const int BOARDS_COUNT = 1 << 16;
+static const int ROUNDS_COUNT = 64;
+
+
+using Game::Internal::Board;
+using Game::Internal::BoardEngine;
+using Game::Internal::Direction;
+using Game::Internal::Directions;
+using Game::Internal::Heuristic;
+using Game::Internal::KernelResult;
+using Game::Internal::MoveKernel;
+using Game::Internal::MoveKernels;
+using Game::Internal::MoveResult;
+
+using Cells = std::vector<int>;
+
+
+// The slide and merge rules of the GameController cell walk applied to plain tile values
+static int moveCells(Cells &cells, int rows, int columns, Direction direction)
+{
+    int score = 0;
+
+    if (Direction::Up == direction || Direction::Down == direction) {
+        std::swap(rows, columns);
+    }
+
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0, previousColumn = 0; column < columns; ++column) {
+            int cellIndex = 0;
+            int previousCellIndex = 0;
+
+            switch (direction) {
+            case Direction::Left:
+                cellIndex = row * columns + column;
+                previousCellIndex = row * columns + previousColumn;
+                break;
+            case Direction::Right:
+                cellIndex = row * columns + columns - 1 - column;
+                previousCellIndex = row * columns + columns - 1 - previousColumn;
+                break;
+            case Direction::Up:
+                cellIndex = column * rows + row;
+                previousCellIndex = previousColumn * rows + row;
+                break;
+            case Direction::Down:
+                cellIndex = (columns - 1 - column) * rows + row;
+                previousCellIndex = (columns - 1 - previousColumn) * rows + row;
+                break;
+            }
+
+            if (0 == cells[cellIndex] || cellIndex == previousCellIndex) {
+                continue;
+            }
+
+            if (0 == cells[previousCellIndex]) {
+                cells[previousCellIndex] = cells[cellIndex];
+                cells[cellIndex] = 0;
+                continue;
+            }
+
+            if (cells[previousCellIndex] == cells[cellIndex]) {
+                cells[previousCellIndex] *= 2;
+                cells[cellIndex] = 0;
+                score += cells[previousCellIndex];
+                ++previousColumn;
+                continue;
+            }
+
+            --column;
+            ++previousColumn;
+        }
+    }
+
+    return score;
+}
+
+
+static Board randomBoard(std::mt19937 &random)
+{
+    std::uniform_int_distribution<int> emptyCell(0, 2);
+    std::uniform_int_distribution<int> exponent(1, 11);
+
+    Board board = 0;
+
+    for (int cell = 0; cell < BoardEngine::CELLS; ++cell) {
+        if (0 != emptyCell(random)) {
+            board = BoardEngine::setExponent(board, cell, exponent(random));
+        }
+    }
+
+    return board;
+}
+
+
+static std::vector<std::uint8_t> randomCells(std::mt19937 &random, int size)
+{
+    std::uniform_int_distribution<int> emptyCell(0, 2);
+    std::uniform_int_distribution<int> exponent(1, 11);
+
+    std::vector<std::uint8_t> cells(std::size_t(size * size));
+
+    for (auto &cell : cells) {
+        cell = 0 != emptyCell(random) ? std::uint8_t(exponent(random)) : 0;
+    }
+
+    return cells;
+}
+
+
+static Cells boardCells(Board board)
+{
+    Cells cells(BoardEngine::CELLS);
+
+    for (int cell = 0; cell < BoardEngine::CELLS; ++cell) {
+        cells[cell] = BoardEngine::valueFromExponent(BoardEngine::exponent(board, cell));
+    }
+
+    return cells;
+}
+
+
+// The heuristic summed line by line without the row table
+static double walkHeuristic(Board board, const Heuristic &heuristic)
+{
+    double score = 0.0;
+
+    for (const Board lines : { board, BoardEngine::transpose(board) }) {
+        for (int row = 0; row < BoardEngine::ROWS; ++row) {
+            int exponents[BoardEngine::COLUMNS];
+            for (int column = 0; column < BoardEngine::COLUMNS; ++column) {
+                exponents[column] = BoardEngine::exponent(lines, row * BoardEngine::COLUMNS + column);
+            }
+            score += Heuristic::lineScore(exponents, heuristic.weights());
+        }
+    }
+
+    return score;
+}
+
+
+template<typename Function>
+static double measureEvaluation(const char *name, std::size_t boards, Function function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const double checksum = function();
+    const auto finish = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(finish - start).count();
+    const double evaluations = double(boards) * ROUNDS_COUNT;
+
+    std::printf("%-12s %8.2f ns/board %10.2f Mboards/s (checksum %.0f)\n",
+                name, seconds * 1e9 / evaluations, evaluations / seconds / 1e6, checksum);
+
+    return seconds;
+}
+
+
+template<typename Function>
+static double measure(const char *name, std::size_t boards, Function function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const long long checksum = function();
+    const auto finish = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(finish - start).count();
+    const double moves = double(boards) * ROUNDS_COUNT * 4;
+
+    std::printf("%-12s %8.2f ns/move %10.2f Mmoves/s (checksum %lld)\n",
+                name, seconds * 1e9 / moves, moves / seconds / 1e6, checksum);
+
+    return seconds;
+}
+
+
+int main()
+{
+    std::mt19937 random(2048);
+
+    std::vector<Board> boards(BOARDS_COUNT);
+    std::vector<Cells> cells(BOARDS_COUNT);
+
+    for (int i = 0; i < BOARDS_COUNT; ++i) {
+        boards[i] = randomBoard(random);
+        cells[i] = boardCells(boards[i]);
+    }
+
+    const Direction directions[] = { Direction::Left, Direction::Right, Direction::Up, Direction::Down };
+
+    int mismatches = 0;
+    for (int i = 0; i < BOARDS_COUNT; ++i) {
+        for (const Direction direction : directions) {
+            Cells moved = cells[i];
+            const int score = moveCells(moved, BoardEngine::ROWS, BoardEngine::COLUMNS, direction);
+            const MoveResult result = BoardEngine::move(boards[i], direction);
+            if (score != result.score || moved != boardCells(result.board)) {
+                ++mismatches;
+            }
+        }
+    }
+
+    if (0 != mismatches) {
+        std::printf("Row tables disagree with the cell walk on %d moves\n", mismatches);
+        return 1;
+    }
+
+    const double cellWalk = measure("cell walk", cells.size(), [&]() {
+        long long checksum = 0;
+        Cells moved;
+        for (int round = 0; round < ROUNDS_COUNT; ++round) {
+            for (const Cells &board : cells) {
+                for (const Direction direction : directions) {
+                    moved = board;
+                    checksum += moveCells(moved, BoardEngine::ROWS, BoardEngine::COLUMNS, direction);
+                }
+            }
+        }
+        return checksum;
+    });
+
+    const double rowTables = measure("row tables", boards.size(), [&]() {
+        long long checksum = 0;
+        for (int round = 0; round < ROUNDS_COUNT; ++round) {
+            for (const Board board : boards) {
+                for (const Direction direction : directions) {
+                    checksum += BoardEngine::move(board, direction).score;
+                }
+            }
+        }
+        return checksum;
+    });
+
+    std::printf("Speedup: %.1fx\n", cellWalk / rowTables);
+
+    const double moveChecks = measure("move checks", boards.size(), [&]() {
+        long long checksum = 0;
+        for (int round = 0; round < ROUNDS_COUNT; ++round) {
+            for (const Board board : boards) {
+                Directions legalMoves = 0;
+                for (const Direction direction : directions) {
+                    if (BoardEngine::move(board, direction).board != board) {
+                        legalMoves |= BoardEngine::directionBit(direction);
+                    }
+                }
+                checksum += legalMoves;
+            }
+        }
+        return checksum;
+    });
+
+    const double legalMoves = measure("legal moves", boards.size(), [&]() {
+        long long checksum = 0;
+        for (int round = 0; round < ROUNDS_COUNT; ++round) {
+            for (const Board board : boards) {
+                checksum += BoardEngine::legalMoves(board);
+            }
+        }
+        return checksum;
+    });
+
+    std::printf("Speedup: %.1fx\n", moveChecks / legalMoves);
+
+    const Heuristic heuristic;
+
+    for (const Board board : boards) {
+        const double expected = walkHeuristic(board, heuristic);
+        if (std::fabs(expected - heuristic.evaluate(board)) > std::fabs(expected) * 1e-5) {
+            ++mismatches;
+        }
+    }
+
+    if (0 != mismatches) {
+        std::printf("Heuristic table disagrees with the line walk on %d boards\n", mismatches);
+        return 1;
+    }
+
+    const double lineWalk = measureEvaluation("line walk", boards.size(), [&]() {
+        double checksum = 0.0;
+        for (int round = 0; round < ROUNDS_COUNT; ++round) {
+            for (const Board board : boards) {
+                checksum += walkHeuristic(board, heuristic);
+            }
+        }
+        return checksum;
+    });
+
+    const double heuristicTable = measureEvaluation("row scores", boards.size(), [&]() {
+        double checksum = 0.0;
+        for (int round = 0; round < ROUNDS_COUNT; ++round) {
+            for (const Board board : boards) {
+                checksum += heuristic.evaluate(board);
+            }
+        }
+        return checksum;
+    });
+
+    std::printf("Speedup: %.1fx\n", lineWalk / heuristicTable);
+
+    for (const int size : { 5, 6, 8, 12, 16 }) {
+        std::vector<std::vector<std::uint8_t>> grids(std::size_t(BOARDS_COUNT * BoardEngine::CELLS / (size * size)));
+        for (auto &grid : grids) {
+            grid = randomCells(random, size);
+        }
+
+        const auto moveGrids = [&](MoveKernel kernel) {
+            long long checksum = 0;
+            std::vector<std::uint8_t> moved;
+            for (int round = 0; round < ROUNDS_COUNT; ++round) {
+                for (const auto &grid : grids) {
+                    for (const Direction direction : directions) {
+                        moved = grid;
+                        checksum += kernel(moved.data(), size, size, direction, nullptr).score;
+                    }
+                }
+            }
+            return checksum;
+        };
+
+        std::printf("%dx%d boards\n", size, size);
+        const double generic = measure("generic", grids.size(), [&]() { return moveGrids(&MoveKernels::moveCells); });
+        const double selected = measure("selected", grids.size(), [&]() { return moveGrids(MoveKernels::kernel(size, size)); });
+        std::printf("Speedup: %.1fx\n", generic / selected);
+
+        if (MoveKernels::hasVectorKernel()) {
+            const double vector = measure("vector", grids.size(), [&]() { return moveGrids(&MoveKernels::moveVectorCells); });
+            std::printf("Speedup: %.1fx\n", generic / vector);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,294 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "boardengine.h"
+#include "expectimax.h"
+#include "iterativedeepening.h"
+#include "mctsplayer.h"
+#include "montecarloplayer.h"
+#include "ntuplenetwork.h"
+#include "randomgenerator.h"
+#include "tdtrainer.h"
+#include "threadpool.h"
+#include "transpositiontable.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static const int POSITIONS_COUNT = 24;
+static const int RANDOM_MOVES_COUNT = 60;
+static const int SEARCH_DEPTH = 4;
+static const std::size_t TRANSPOSITION_TABLE_ENTRIES = 1 << 22;
+static const int ROLLOUTS_COUNT = 200;
+static const int MCTS_ITERATIONS = 2000;
+static const int TRAINING_GAMES = 1000;
+static const int LADDER_POSITIONS_COUNT = 8;
+static const int LADDER_BUDGETS[] = { 5, 50, 500 };
+
+
+using Game::Internal::Board;
+using Game::Internal::BoardEngine;
+using Game::Internal::DeepeningResult;
+using Game::Internal::Direction;
+using Game::Internal::Expectimax;
+using Game::Internal::IterativeDeepening;
+using Game::Internal::MctsPlayer;
+using Game::Internal::MctsResult;
+using Game::Internal::MonteCarloPlayer;
+using Game::Internal::NTupleNetwork;
+using Game::Internal::RandomGenerator;
+using Game::Internal::ReplacementPolicy;
+using Game::Internal::RolloutResult;
+using Game::Internal::SearchResult;
+using Game::Internal::TdTrainer;
+using Game::Internal::ThreadPool;
+using Game::Internal::TrainingStatistics;
+using Game::Internal::TranspositionStatistics;
+using Game::Internal::TranspositionTable;
+
+
+static Board spawnTile(Board board, RandomGenerator &random)
+{
+    if (0 == BoardEngine::emptyCellsCount(board)) {
+        return board;
+    }
+
+    return BoardEngine::spawnRandomTile(board, random);
+}
+
+
+// Mid-game positions reached by random play
+static std::vector<Board> randomPositions(RandomGenerator &random)
+{
+    std::vector<Board> positions;
+
+    while (int(positions.size()) < POSITIONS_COUNT) {
+        Board board = spawnTile(spawnTile(0, random), random);
+
+        for (int move = 0; move < RANDOM_MOVES_COUNT && 0 != BoardEngine::legalMoves(board); ++move) {
+            const Direction direction = Direction(random.bounded(4));
+            const Board moved = BoardEngine::move(board, direction).board;
+            if (moved != board) {
+                board = spawnTile(moved, random);
+            }
+        }
+
+        if (0 != BoardEngine::legalMoves(board)) {
+            positions.push_back(board);
+        }
+    }
+
+    return positions;
+}
+
+
+int main()
+{
+    RandomGenerator random(2048);
+    const std::vector<Board> positions = randomPositions(random);
+
+    std::vector<int> threadCounts;
+    const int hardwareThreads = int(std::thread::hardware_concurrency());
+    for (int threads = 1; threads < hardwareThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardwareThreads);
+
+    std::vector<SearchResult> reference;
+    double singleThread = 0.0;
+
+    std::printf("Expectimax depth %d, %d positions\n", SEARCH_DEPTH, POSITIONS_COUNT);
+
+    for (const int threads : threadCounts) {
+        ThreadPool pool(threads);
+        Expectimax search(&pool);
+        search.setDepth(SEARCH_DEPTH);
+
+        std::vector<SearchResult> results;
+        std::uint64_t nodes = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const Board board : positions) {
+            results.push_back(search.search(board));
+            nodes += results.back().nodes;
+        }
+        const auto finish = std::chrono::steady_clock::now();
+
+        const double seconds = std::chrono::duration<double>(finish - start).count();
+        if (reference.empty()) {
+            reference = results;
+            singleThread = seconds;
+        }
+
+        int mismatches = 0;
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            if (results[i].bestMove != reference[i].bestMove || results[i].values != reference[i].values) {
+                ++mismatches;
+            }
+        }
+
+        std::printf("%3d threads %8.2f ms/search %8.2f Mnodes/s speedup %5.2fx%s\n",
+                    threads, seconds * 1e3 / positions.size(), nodes / seconds / 1e6, singleThread / seconds,
+                    0 == mismatches ? "" : " (results differ)");
+    }
+
+    ThreadPool pool(hardwareThreads);
+    const struct { const char *name; ReplacementPolicy policy; } policies[] = {
+        { "always", ReplacementPolicy::Always },
+        { "depth", ReplacementPolicy::Depth },
+        { "generation", ReplacementPolicy::Generation }
+    };
+
+    std::printf("Transposition table, %zu entries, %d threads\n", TRANSPOSITION_TABLE_ENTRIES, hardwareThreads);
+
+    for (const auto &policy : policies) {
+        TranspositionTable table(TRANSPOSITION_TABLE_ENTRIES, policy.policy);
+        Expectimax search(&pool);
+        search.setDepth(SEARCH_DEPTH);
+        search.setTranspositionTable(&table);
+
+        int sameMoves = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            if (search.search(positions[i]).bestMove == reference[i].bestMove) {
+                ++sameMoves;
+            }
+        }
+        const auto finish = std::chrono::steady_clock::now();
+
+        const double seconds = std::chrono::duration<double>(finish - start).count();
+        const TranspositionStatistics statistics = table.statistics();
+
+        std::printf("%-10s %8.2f ms/search speedup %5.2fx hits %5.1f%% collisions %llu probes %.2f same moves %d/%d\n",
+                    policy.name, seconds * 1e3 / positions.size(), singleThread / seconds, statistics.hitRate() * 100.0,
+                    static_cast<unsigned long long>(statistics.collisions), statistics.averageProbeLength(),
+                    sameMoves, POSITIONS_COUNT);
+    }
+
+    std::printf("Iterative deepening, %d positions, %d threads\n", LADDER_POSITIONS_COUNT, hardwareThreads);
+
+    for (const int budget : LADDER_BUDGETS) {
+        TranspositionTable table(TRANSPOSITION_TABLE_ENTRIES, ReplacementPolicy::Generation);
+        Expectimax search(&pool);
+        search.setTranspositionTable(&table);
+        IterativeDeepening deepening(search);
+
+        int depths = 0;
+        int minDepth = IterativeDeepening::DEFAULT_MAX_DEPTH;
+        double maxSeconds = 0.0;
+        std::uint64_t nodes = 0;
+        double seconds = 0.0;
+
+        for (int i = 0; i < LADDER_POSITIONS_COUNT; ++i) {
+            const DeepeningResult result = deepening.search(positions[std::size_t(i)], std::chrono::milliseconds(budget));
+            depths += result.depth;
+            minDepth = std::min(minDepth, result.depth);
+            maxSeconds = std::max(maxSeconds, result.seconds);
+            nodes += result.nodes;
+            seconds += result.seconds;
+        }
+
+        std::printf("%4d ms budget depth %5.2f (min %d) max time %8.2f ms %8.2f Mnodes/s\n",
+                    budget, double(depths) / LADDER_POSITIONS_COUNT, minDepth, maxSeconds * 1e3, nodes / seconds / 1e6);
+    }
+
+    std::printf("Monte Carlo, %d rollouts per move\n", ROLLOUTS_COUNT);
+
+    std::vector<RolloutResult> rolloutReference;
+
+    for (const int threads : threadCounts) {
+        ThreadPool rolloutPool(threads);
+        MonteCarloPlayer player(&rolloutPool, 2048);
+        player.setRollouts(ROLLOUTS_COUNT);
+
+        std::vector<RolloutResult> results;
+        std::uint64_t rollouts = 0;
+        std::uint64_t moves = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const Board board : positions) {
+            results.push_back(player.search(board));
+            rollouts += results.back().rollouts;
+            moves += results.back().moves;
+        }
+        const auto finish = std::chrono::steady_clock::now();
+
+        const double seconds = std::chrono::duration<double>(finish - start).count();
+        if (rolloutReference.empty()) {
+            rolloutReference = results;
+        }
+
+        int mismatches = 0;
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            if (results[i].meanScores != rolloutReference[i].meanScores) {
+                ++mismatches;
+            }
+        }
+
+        std::printf("%3d threads %10.0f rollouts/s %8.2f Mmoves/s%s\n", threads, rollouts / seconds,
+                    moves / seconds / 1e6, 0 == mismatches ? "" : " (results differ)");
+    }
+
+    std::printf("Monte Carlo tree search, %d iterations per move\n", MCTS_ITERATIONS);
+
+    // Threads share the tree, so the results depend on the thread count and are not compared
+    for (const int threads : threadCounts) {
+        ThreadPool treePool(threads);
+        MctsPlayer player(&treePool, 2048);
+        player.setIterations(MCTS_ITERATIONS);
+
+        std::uint64_t iterations = 0;
+        std::size_t arenaUsed = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (const Board board : positions) {
+            const MctsResult result = player.search(board);
+            iterations += result.iterations;
+            arenaUsed = std::max(arenaUsed, result.arenaUsed);
+        }
+        const auto finish = std::chrono::steady_clock::now();
+
+        const double seconds = std::chrono::duration<double>(finish - start).count();
+        std::printf("%3d threads %10.0f iterations/s arena peak %6.2f MB\n", threads, iterations / seconds,
+                    arenaUsed / double(1 << 20));
+    }
+
+    std::printf("TD(0) n-tuple training, %d games\n", TRAINING_GAMES);
+
+    for (const int threads : threadCounts) {
+        ThreadPool trainingPool(threads);
+        NTupleNetwork network;
+        TdTrainer trainer(network, &trainingPool, 2048);
+
+        const TrainingStatistics statistics = trainer.train(TRAINING_GAMES);
+
+        std::printf("%3d threads %8.0f games/s %8.2f Mmoves/s mean score %8.0f max score %u\n",
+                    threads, statistics.gamesPerSecond(), statistics.moves / statistics.seconds / 1e6,
+                    statistics.meanScore(), statistics.maxScore);
+    }
+
+    return 0;
+}
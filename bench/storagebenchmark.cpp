@@ -0,0 +1,256 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "batchinsertquery.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QVariant>
+#include <QVariantList>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+static const char *const DATABASE_TYPE = "QSQLITE";
+static const char *const CONNECTION_NAME = "storage-bench";
+static const char *const DATABASE_NAME = "bench.sqlite3";
+static const char *const DIRECTORY_TEMPLATE = "2048-storage-bench-XXXXXX";
+static const int TURNS_COUNT = 200;
+static const int BOARD_SIDES[] = { 4, 8, 16 };
+
+
+using Game::Internal::BatchInsertQuery;
+
+using SaveTiles = std::function<bool(QSqlDatabase &, int, const QVariantList &)>;
+
+
+static bool executeFileQueries(QSqlDatabase &db, const QString &fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::fprintf(stderr, "Can't open %s\n", qPrintable(fileName));
+        return false;
+    }
+
+    const QStringList &queries = QString(file.readAll()).simplified().split(QLatin1Char(';'), QString::SkipEmptyParts);
+
+    QSqlQuery sqlQuery(db);
+
+    for (const auto &query : queries) {
+        if (!sqlQuery.exec(query)) {
+            std::fprintf(stderr, "Can't execute %s: %s\n", qPrintable(query), qPrintable(sqlQuery.lastError().text()));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// The tiles of a full board, four values a tile as the storage worker binds them
+static QVariantList boardTiles(int turnId, int cells)
+{
+    QVariantList values;
+
+    for (int cell = 0; cell < cells; ++cell) {
+        values << turnId << cell << (2 << (cell % 11)) << cell;
+    }
+
+    return values;
+}
+
+
+// The storage worker before the batched inserts: a statement prepared every turn and run for every tile
+static bool saveTilesByRow(QSqlDatabase &db, int turnId, const QVariantList &values)
+{
+    QSqlQuery sqlQuery(db);
+
+    if (!sqlQuery.prepare(QLatin1Literal("INSERT INTO tiles (turn_id, tile_id, tile_value, cell_index) "
+                                         "VALUES (?, ?, ?, ?)"))) {
+        return false;
+    }
+
+    for (int value = 0; value < values.size(); value += 4) {
+        sqlQuery.addBindValue(turnId);
+        sqlQuery.addBindValue(values.at(value + 1));
+        sqlQuery.addBindValue(values.at(value + 2));
+        sqlQuery.addBindValue(values.at(value + 3));
+
+        if (!sqlQuery.exec()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// A turn as the storage worker saves it, in one transaction with its tiles
+static bool saveTurn(QSqlDatabase &db, int turnId, const QVariantList &tiles, const SaveTiles &saveTiles)
+{
+    if (!db.transaction()) {
+        return false;
+    }
+
+    QSqlQuery sqlQuery(db);
+
+    bool ok = sqlQuery.prepare(QLatin1Literal("INSERT INTO turns (turn_id, parent_turn_id, move_direction, score, "
+                                              "best_score) VALUES (?, ?, ?, ?, ?)"));
+
+    sqlQuery.addBindValue(turnId);
+    sqlQuery.addBindValue(turnId - 1);
+    sqlQuery.addBindValue(1);
+    sqlQuery.addBindValue(turnId * 4);
+    sqlQuery.addBindValue(turnId * 4);
+
+    ok = ok && sqlQuery.exec() && saveTiles(db, turnId, tiles) && db.commit();
+
+    if (!ok) {
+        db.rollback();
+    }
+
+    return ok;
+}
+
+
+// Tile rows and a checksum of their values, so both paths are seen to store the same tiles
+static bool storedTiles(QSqlDatabase &db, qint64 &rows, qint64 &checksum)
+{
+    QSqlQuery sqlQuery(db);
+
+    if (!sqlQuery.exec(QLatin1Literal("SELECT COUNT(*), TOTAL(turn_id * 7 + tile_id * 5 + tile_value * 3 + cell_index) "
+                                      "FROM tiles")) || !sqlQuery.first()) {
+        return false;
+    }
+
+    rows = sqlQuery.value(0).toLongLong();
+    checksum = sqlQuery.value(1).toLongLong();
+
+    return sqlQuery.exec(QLatin1Literal("DELETE FROM tiles")) && sqlQuery.exec(QLatin1Literal("DELETE FROM turns"));
+}
+
+
+static bool measure(const char *name, QSqlDatabase &db, int cells, const SaveTiles &saveTiles,
+                    qint64 &rows, qint64 &checksum)
+{
+    std::vector<double> latencies;
+    latencies.reserve(TURNS_COUNT);
+
+    for (int turnId = 1; turnId <= TURNS_COUNT; ++turnId) {
+        const QVariantList &tiles = boardTiles(turnId, cells);
+
+        const auto start = std::chrono::steady_clock::now();
+        if (!saveTurn(db, turnId, tiles, saveTiles)) {
+            std::fprintf(stderr, "Can't save a turn: %s\n", qPrintable(db.lastError().text()));
+            return false;
+        }
+        const auto finish = std::chrono::steady_clock::now();
+
+        latencies.push_back(std::chrono::duration<double, std::micro>(finish - start).count());
+    }
+
+    const double mean = std::accumulate(latencies.cbegin(), latencies.cend(), 0.0) / latencies.size();
+    std::sort(latencies.begin(), latencies.end());
+
+    std::printf("%-8s %4d tiles: mean %9.1f us, p50 %9.1f us, p99 %9.1f us\n", name, cells, mean,
+                latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100]);
+
+    return storedTiles(db, rows, checksum);
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+
+    // The database goes to the given directory, so the device the game writes to can be measured
+    const QDir parent = (1 < argc) ? QDir(QString::fromLocal8Bit(argv[1])) : QDir::temp();
+    const QTemporaryDir directory(parent.filePath(QLatin1Literal(DIRECTORY_TEMPLATE)));
+    if (!directory.isValid()) {
+        std::fprintf(stderr, "Can't create a temporary directory\n");
+        return 1;
+    }
+
+    int result = 1;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QLatin1Literal(DATABASE_TYPE), QLatin1Literal(CONNECTION_NAME));
+        db.setDatabaseName(QDir(directory.path()).filePath(QLatin1Literal(DATABASE_NAME)));
+
+        if (db.open() && executeFileQueries(db, QLatin1Literal(SQL_DIRECTORY "/configure.sql"))
+                && executeFileQueries(db, QLatin1Literal(SQL_DIRECTORY "/tables.sql"))) {
+            BatchInsertQuery batchQuery(QLatin1Literal("tiles"), QStringList() << QLatin1Literal("turn_id")
+                                        << QLatin1Literal("tile_id") << QLatin1Literal("tile_value")
+                                        << QLatin1Literal("cell_index"));
+            batchQuery.setDatabase(db);
+
+            const SaveTiles saveTilesBatched = [&batchQuery](QSqlDatabase &, int, const QVariantList &values) {
+                return batchQuery.exec(values);
+            };
+
+            result = 0;
+
+            std::printf("%d turns a board size, database in %s\n", TURNS_COUNT, qPrintable(directory.path()));
+
+            for (const int side : BOARD_SIDES) {
+                qint64 byRowRows = 0;
+                qint64 byRowChecksum = 0;
+                qint64 batchedRows = 0;
+                qint64 batchedChecksum = 0;
+
+                if (!measure("by row", db, side * side, &saveTilesByRow, byRowRows, byRowChecksum)
+                        || !measure("batched", db, side * side, saveTilesBatched, batchedRows, batchedChecksum)) {
+                    result = 1;
+                    break;
+                }
+
+                if (byRowRows != batchedRows || byRowChecksum != batchedChecksum) {
+                    std::fprintf(stderr, "The batched inserts store other tiles\n");
+                    result = 1;
+                    break;
+                }
+            }
+
+            batchQuery.setDatabase(QSqlDatabase());
+        } else {
+            std::fprintf(stderr, "Can't create the database: %s\n", qPrintable(db.lastError().text()));
+        }
+
+        db.close();
+    }
+
+    QSqlDatabase::removeDatabase(QLatin1Literal(CONNECTION_NAME));
+
+    return result;
+}
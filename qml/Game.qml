@@ -31,10 +31,13 @@ Item {
 
     property bool undoButtonEnabled: false
     property bool undoButtonAnimation: false
+    property string hintDirection: ''
+    property int autoplayRate: 0
 
     signal continueGameRequested
     signal startNewGameRequested
     signal undoRequested
+    signal hintRequested
 
     objectName: 'Game'
     state: 'init'
@@ -142,6 +145,19 @@ Item {
         Behavior on opacity { enabled: undoButtonAnimation; NumberAnimation { duration: 200 } }
     }
 
+    Button {
+        id: hintButton
+
+        anchors.left: undoButton.right
+        anchors.leftMargin: 5
+        anchors.verticalCenter: newGameButton.verticalCenter
+        visible: undoButton.visible
+        opacity: undoButton.opacity
+        width: 80
+        text: qsTr('Hint')
+        onClicked: hintRequested()
+    }
+
     Button {
         id: newGameButton
 
@@ -172,6 +188,29 @@ Item {
         focus: true
     }
 
+    Text {
+        id: hintText
+
+        anchors.centerIn: gameboard
+        visible: 0.0 !== opacity
+        opacity: '' === hintDirection ? 0.0 : 0.6
+        rotation: {
+            switch (hintDirection) {
+            case 'left': return 180
+            case 'up': return 270
+            case 'down': return 90
+            default: return 0
+            }
+        }
+        font.family: Constants.fontFamily
+        font.pixelSize: Math.round(gameboard.width * 0.4)
+        font.weight: Font.Bold
+        color: '#776e65'
+        text: '\u2192'
+
+        Behavior on opacity { NumberAnimation { duration: 100 } }
+    }
+
     Text {
         id: rulesText
 
@@ -186,7 +225,22 @@ Item {
         wrapMode: Text.WordWrap
 
         text: qsTr('<b>HOW TO PLAY:</b> Use your <b>arrow keys</b> to move the tiles. '
-                   + 'When two tiles with the same number touch, they <b>merge into one!</b>')
+                   + 'When two tiles with the same number touch, they <b>merge into one!</b> '
+                   + 'Press <b>H</b> for a hint, <b>A</b> for autoplay and <b>+</b>/<b>-</b> to change its speed.')
+    }
+
+    Text {
+        id: autoplayText
+
+        anchors.left: gameboard.left
+        anchors.top: rulesText.bottom
+        anchors.topMargin: 10
+        visible: 0 < autoplayRate
+        font.family: Constants.fontFamily
+        font.pixelSize: 18
+        font.weight: Font.Bold
+        color: '#776e65'
+        text: qsTr('AUTOPLAY: %1 moves/s').arg(autoplayRate)
     }
 
     Loader {
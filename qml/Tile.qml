@@ -31,6 +31,7 @@ Rectangle {
     property int previousValue: 0
     property bool hidden: true
     property bool animation: true
+    property bool moveAnimation: true
     property int moveAnimationDuration: 100
 
     readonly property real largeFontRatio: 0.52
@@ -72,7 +73,7 @@ Rectangle {
     }
 
     Behavior on x {
-        enabled: !hidden
+        enabled: !hidden && moveAnimation
         NumberAnimation {
             duration: moveAnimationDuration
             easing.type: Easing.InOutQuad
@@ -81,7 +82,7 @@ Rectangle {
     }
 
     Behavior on y {
-        enabled: !hidden
+        enabled: !hidden && moveAnimation
         NumberAnimation {
             duration: moveAnimationDuration
             easing.type: Easing.InOutQuad
@@ -263,7 +264,7 @@ Rectangle {
     ]
 
     onValueChanged: {
-        if (previousValue < value) {
+        if (previousValue < value && moveAnimation) {
             bounceAnimation.running = true
         }
         previousValue = value;
@@ -6,7 +6,8 @@ CREATE TABLE IF NOT EXISTS games
                            columns INTEGER NOT NULL,
                            score INTEGER NOT NULL DEFAULT 0,
                            best_score INTEGER NOT NULL DEFAULT 0,
-                           game_state INTEGER NOT NULL DEFAULT 1);
+                           game_state INTEGER NOT NULL DEFAULT 1,
+                           seed INTEGER NOT NULL DEFAULT 0);
 
 CREATE TABLE IF NOT EXISTS turns
                           (turn_id INTEGER PRIMARY KEY NOT NULL,
@@ -27,4 +28,4 @@ CREATE INDEX tiles_turn_id ON tiles(turn_id);
 
 CREATE INDEX tiles_cell_index ON tiles(cell_index);
 
-PRAGMA user_version = 1;
+PRAGMA user_version = 2;
@@ -0,0 +1,3 @@
+ALTER TABLE games ADD COLUMN seed INTEGER NOT NULL DEFAULT 0;
+
+PRAGMA user_version = 2;
@@ -0,0 +1,82 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "arena.h"
+
+#include <algorithm>
+
+static const std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+
+namespace Game {
+namespace Internal {
+
+static std::size_t alignedSize(std::size_t size)
+{
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+
+Arena::Arena(std::size_t capacity) :
+    m_capacity(alignedSize(capacity)),
+    m_block(new std::max_align_t[(m_capacity + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)]),
+    m_used(0)
+{
+}
+
+
+Arena::~Arena() = default;
+
+
+std::size_t Arena::capacity() const
+{
+    return m_capacity;
+}
+
+
+std::size_t Arena::used() const
+{
+    return std::min(m_used.load(std::memory_order_relaxed), m_capacity);
+}
+
+
+void *Arena::allocate(std::size_t size)
+{
+    size = alignedSize(size);
+
+    // A failed allocation leaves the offset past the end, the later ones fail too
+    const std::size_t offset = m_used.fetch_add(size, std::memory_order_relaxed);
+    if (m_capacity < offset + size) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<unsigned char*>(m_block.get()) + offset;
+}
+
+
+void Arena::reset()
+{
+    m_used.store(0, std::memory_order_relaxed);
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,76 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace Game {
+namespace Internal {
+
+// Bump allocator over one block. Threads allocate without locks and reset frees everything at once,
+// so only trivially destructible objects may live in it.
+class Arena final
+{
+public:
+    explicit Arena(std::size_t capacity);
+    ~Arena();
+
+    std::size_t capacity() const;
+    std::size_t used() const;
+
+    // Null when the block is used up, every allocation is aligned for any fundamental type
+    void *allocate(std::size_t size);
+
+    template<typename T, typename... Args>
+    T *create(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Arena objects can't be over-aligned");
+
+        void *memory = allocate(sizeof(T));
+        return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    // No allocation may be in use or in progress
+    void reset();
+
+private:
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    const std::size_t m_capacity;
+    const std::unique_ptr<std::max_align_t[]> m_block;
+    std::atomic<std::size_t> m_used;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // ARENA_H
@@ -0,0 +1,112 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "batchinsertquery.h"
+
+#include <QtGlobal>
+
+
+namespace Game {
+namespace Internal {
+
+BatchInsertQuery::BatchInsertQuery(const QString &table, const QStringList &columns) :
+    m_table(table),
+    m_columns(columns),
+    m_maxRows(MAX_PARAMETERS / columns.size())
+{
+    Q_ASSERT(!columns.isEmpty() && columns.size() <= MAX_PARAMETERS);
+}
+
+
+void BatchInsertQuery::setDatabase(const QSqlDatabase &db)
+{
+    m_queries.clear();
+    m_db = db;
+}
+
+
+bool BatchInsertQuery::exec(const QVariantList &values)
+{
+    const int columns = m_columns.size();
+    Q_ASSERT(0 == values.size() % columns);
+
+    const int rows = values.size() / columns;
+
+    for (int firstRow = 0; firstRow < rows; firstRow += m_maxRows) {
+        const int batchRows = qMin(m_maxRows, rows - firstRow);
+        QSqlQuery *sqlQuery = query(batchRows);
+
+        if (!sqlQuery) {
+            return false;
+        }
+
+        const int firstValue = firstRow * columns;
+        for (int value = 0; value < batchRows * columns; ++value) {
+            sqlQuery->bindValue(value, values.at(firstValue + value));
+        }
+
+        if (!sqlQuery->exec()) {
+            m_lastError = sqlQuery->lastError();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+QSqlError BatchInsertQuery::lastError() const
+{
+    return m_lastError;
+}
+
+
+QSqlQuery *BatchInsertQuery::query(int rows)
+{
+    auto it = m_queries.find(rows);
+    if (m_queries.end() != it) {
+        return &it.value();
+    }
+
+    const QString &placeholders = QString(QLatin1Literal("?, ")).repeated(m_columns.size() - 1);
+    const QString &row = QString(QLatin1Literal("(%1?)")).arg(placeholders);
+
+    QStringList rowsValues;
+    for (int i = 0; i < rows; ++i) {
+        rowsValues.append(row);
+    }
+
+    const QString &query = QString(QLatin1Literal("INSERT INTO %1 (%2) VALUES %3"))
+            .arg(m_table, m_columns.join(QLatin1Literal(", ")), rowsValues.join(QLatin1Literal(", ")));
+
+    QSqlQuery sqlQuery(m_db);
+
+    if (!sqlQuery.prepare(query)) {
+        m_lastError = sqlQuery.lastError();
+        return nullptr;
+    }
+
+    return &m_queries.insert(rows, sqlQuery).value();
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,69 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef BATCHINSERTQUERY_H
+#define BATCHINSERTQUERY_H
+
+#include <QMap>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+
+
+namespace Game {
+namespace Internal {
+
+// Inserts rows with multi-row INSERT statements. A statement is prepared the first time
+// it is run with a row count and reused afterwards, so a turn costs one or two executions.
+class BatchInsertQuery final
+{
+public:
+    // SQLite before 3.32 takes up to 999 parameters per statement
+    static const int MAX_PARAMETERS = 999;
+
+    BatchInsertQuery(const QString &table, const QStringList &columns);
+
+    // Drops the prepared statements, they have to go before their database is closed
+    void setDatabase(const QSqlDatabase &db);
+
+    // Values are the ones of the first row, then the ones of the second row, and so on
+    bool exec(const QVariantList &values);
+    QSqlError lastError() const;
+
+private:
+    QSqlQuery *query(int rows);
+
+    const QString m_table;
+    const QStringList m_columns;
+    const int m_maxRows;
+    QSqlDatabase m_db;
+    QMap<int, QSqlQuery> m_queries;
+    QSqlError m_lastError;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // BATCHINSERTQUERY_H
@@ -0,0 +1,98 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef BITOPERATIONS_H
+#define BITOPERATIONS_H
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+
+namespace Game {
+namespace Internal {
+
+inline int popCount(std::uint64_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(value);
+#else
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return int((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+
+inline int countTrailingZeros(std::uint64_t value)
+{
+#if defined(__GNUC__)
+    return 0 == value ? 64 : __builtin_ctzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index = 0;
+    return _BitScanForward64(&index, value) ? int(index) : 64;
+#else
+    if (0 == value) {
+        return 64;
+    }
+    int count = 0;
+    while (0 == (value & 1)) {
+        value >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+
+// Index of the set bit with the given rank, counting from the least significant bit
+inline int selectBit(std::uint64_t value, int rank)
+{
+#if defined(__BMI2__) && defined(__x86_64__)
+    return countTrailingZeros(_pdep_u64(std::uint64_t(1) << rank, value));
+#else
+    for (int shift = 0; shift < 64; shift += 8) {
+        const int bits = popCount((value >> shift) & 0xFF);
+        if (rank < bits) {
+            value >>= shift;
+            for (; 0 < rank; --rank) {
+                value &= value - 1;
+            }
+            return shift + countTrailingZeros(value);
+        }
+        rank -= bits;
+    }
+    return 64;
+#endif
+}
+
+} // namespace Internal
+} // namespace Game
+
+#endif // BITOPERATIONS_H
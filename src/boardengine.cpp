@@ -0,0 +1,492 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "boardengine.h"
+#include "bitoperations.h"
+#include "randomgenerator.h"
+
+#include <cassert>
+
+static const int CELL_BITS = 4;
+static const std::uint64_t CELL_MASK = 0xF;
+static const std::uint64_t CELL_LOW_BITS = 0x1111111111111111ULL;
+// Cells which have a right and a bottom neighbour
+static const std::uint64_t HORIZONTAL_PAIR_BITS = 0x0111011101110111ULL;
+static const std::uint64_t VERTICAL_PAIR_BITS = 0x0000111111111111ULL;
+static const int ROW_BITS = 16;
+static const std::uint64_t ROW_MASK = 0xFFFF;
+static const int ROWS_COUNT = 0x10000;
+static const int TARGET_BITS = 2;
+static const int TARGET_MASK = 0x3;
+
+
+namespace Game {
+namespace Internal {
+
+struct RowMove
+{
+    std::uint32_t score;
+    std::uint16_t row;
+    // 2-bit target column for each source column
+    std::uint8_t targets;
+    std::uint8_t merges;
+};
+
+struct RowTables
+{
+    RowTables();
+
+    RowMove left[ROWS_COUNT];
+    RowMove right[ROWS_COUNT];
+};
+
+
+static std::uint16_t reverseRow(std::uint16_t row)
+{
+    return std::uint16_t(((row & 0x000F) << 12) | ((row & 0x00F0) << 4) | ((row & 0x0F00) >> 4) | ((row & 0xF000) >> 12));
+}
+
+
+static int reverseTargets(int targets)
+{
+    int result = 0;
+
+    for (int column = 0; column < BoardEngine::COLUMNS; ++column) {
+        const int target = (targets >> (column * TARGET_BITS)) & TARGET_MASK;
+        const int reversedColumn = BoardEngine::COLUMNS - 1 - column;
+        result |= (BoardEngine::COLUMNS - 1 - target) << (reversedColumn * TARGET_BITS);
+    }
+
+    return result;
+}
+
+
+static RowMove moveRowLeft(std::uint16_t row)
+{
+    int exponents[BoardEngine::COLUMNS] = {};
+    int score = 0;
+    int merges = 0;
+    int targets = 0;
+    int targetColumn = 0;
+    int previousExponent = 0;
+
+    for (int column = 0; column < BoardEngine::COLUMNS; ++column) {
+        const int exponent = (row >> (column * CELL_BITS)) & CELL_MASK;
+
+        if (0 == exponent) {
+            continue;
+        }
+
+        if (exponent == previousExponent && exponent < BoardEngine::MAX_EXPONENT) {
+            exponents[targetColumn - 1] = exponent + 1;
+            targets |= (targetColumn - 1) << (column * TARGET_BITS);
+            score += BoardEngine::valueFromExponent(exponent + 1);
+            ++merges;
+            previousExponent = 0;
+            continue;
+        }
+
+        exponents[targetColumn] = exponent;
+        targets |= targetColumn << (column * TARGET_BITS);
+        previousExponent = exponent;
+        ++targetColumn;
+    }
+
+    std::uint16_t result = 0;
+    for (int column = 0; column < BoardEngine::COLUMNS; ++column) {
+        result |= std::uint16_t(exponents[column] << (column * CELL_BITS));
+    }
+
+    RowMove rowMove;
+    rowMove.score = std::uint32_t(score);
+    rowMove.row = result;
+    rowMove.targets = std::uint8_t(targets);
+    rowMove.merges = std::uint8_t(merges);
+    return rowMove;
+}
+
+
+RowTables::RowTables()
+{
+    for (int row = 0; row < ROWS_COUNT; ++row) {
+        left[row] = moveRowLeft(std::uint16_t(row));
+
+        const std::uint16_t reversedRow = reverseRow(std::uint16_t(row));
+        RowMove rowMove = moveRowLeft(reversedRow);
+        rowMove.row = reverseRow(rowMove.row);
+        rowMove.targets = std::uint8_t(reverseTargets(rowMove.targets));
+        right[row] = rowMove;
+    }
+}
+
+
+static const RowTables &rowTables()
+{
+    static const RowTables tables;
+    return tables;
+}
+
+
+int BoardEngine::exponent(Board board, int cell)
+{
+    assert(0 <= cell && cell < CELLS);
+
+    return int((board >> (cell * CELL_BITS)) & CELL_MASK);
+}
+
+
+Board BoardEngine::setExponent(Board board, int cell, int exponent)
+{
+    assert(0 <= cell && cell < CELLS);
+    assert(0 <= exponent && exponent <= MAX_EXPONENT);
+
+    const int shift = cell * CELL_BITS;
+    return (board & ~(CELL_MASK << shift)) | (Board(exponent) << shift);
+}
+
+
+int BoardEngine::maxExponent(Board board)
+{
+    int result = 0;
+
+    while (0 != board) {
+        const int exponent = int(board & CELL_MASK);
+        if (result < exponent) {
+            result = exponent;
+        }
+        board >>= CELL_BITS;
+    }
+
+    return result;
+}
+
+
+std::uint64_t BoardEngine::emptyCells(Board board)
+{
+    Board occupied = board | (board >> 2);
+    occupied |= occupied >> 1;
+    return ~occupied & CELL_LOW_BITS;
+}
+
+
+int BoardEngine::emptyCellsCount(Board board)
+{
+    return popCount(emptyCells(board));
+}
+
+
+Board BoardEngine::spawnTile(Board board, int emptyCellRank, int exponent)
+{
+    assert(0 <= emptyCellRank && emptyCellRank < emptyCellsCount(board));
+    assert(0 < exponent && exponent <= MAX_EXPONENT);
+
+    const int shift = selectBit(emptyCells(board), emptyCellRank);
+    return board | (Board(exponent) << shift);
+}
+
+
+Spawn BoardEngine::randomSpawn(int emptyCellsCount, RandomGenerator &random)
+{
+    assert(0 < emptyCellsCount);
+
+    Spawn spawn;
+    spawn.exponent = (0 == random.bounded(FOUR_TILE_ODDS)) ? 2 : 1;
+    spawn.emptyCellRank = int(random.bounded(std::uint32_t(emptyCellsCount)));
+    return spawn;
+}
+
+
+Board BoardEngine::spawnRandomTile(Board board, RandomGenerator &random)
+{
+    const Spawn spawn = randomSpawn(emptyCellsCount(board), random);
+    return spawnTile(board, spawn.emptyCellRank, spawn.exponent);
+}
+
+
+int BoardEngine::spawnRandomTile(std::uint8_t *cells, int cellsCount, RandomGenerator &random)
+{
+    int emptyCellsCount = 0;
+    for (int cell = 0; cell < cellsCount; ++cell) {
+        if (0 == cells[cell]) {
+            ++emptyCellsCount;
+        }
+    }
+
+    const Spawn spawn = randomSpawn(emptyCellsCount, random);
+    int rank = spawn.emptyCellRank;
+
+    for (int cell = 0; cell < cellsCount; ++cell) {
+        if (0 == cells[cell] && 0 == rank--) {
+            cells[cell] = std::uint8_t(spawn.exponent);
+            return cell;
+        }
+    }
+
+    assert(false);
+    return -1;
+}
+
+
+int BoardEngine::exponentFromValue(int value)
+{
+    int exponent = 0;
+
+    while (1 < value) {
+        value >>= 1;
+        ++exponent;
+    }
+
+    return exponent;
+}
+
+
+int BoardEngine::valueFromExponent(int exponent)
+{
+    return 0 == exponent ? 0 : 1 << exponent;
+}
+
+
+int BoardEngine::lineCell(Direction direction, int line, int position)
+{
+    switch (direction) {
+    case Direction::Left:
+        return line * COLUMNS + position;
+    case Direction::Right:
+        return line * COLUMNS + COLUMNS - 1 - position;
+    case Direction::Up:
+        return position * COLUMNS + line;
+    case Direction::Down:
+        return (ROWS - 1 - position) * COLUMNS + line;
+    }
+
+    assert(false);
+    return 0;
+}
+
+
+Board BoardEngine::transpose(Board board)
+{
+    const Board a1 = board & 0xF0F00F0FF0F00F0FULL;
+    const Board a2 = board & 0x0000F0F00000F0F0ULL;
+    const Board a3 = board & 0x0F0F00000F0F0000ULL;
+    const Board a = a1 | (a2 << 12) | (a3 >> 12);
+    const Board b1 = a & 0xFF00FF0000FF00FFULL;
+    const Board b2 = a & 0x00FF00FF00000000ULL;
+    const Board b3 = a & 0x00000000FF00FF00ULL;
+    return b1 | (b2 >> 24) | (b3 << 24);
+}
+
+
+Board BoardEngine::mirrorRows(Board board)
+{
+    return ((board & 0x000F000F000F000FULL) << 12) | ((board & 0x00F000F000F000F0ULL) << 4) |
+           ((board & 0x0F000F000F000F00ULL) >> 4) | ((board & 0xF000F000F000F000ULL) >> 12);
+}
+
+
+Board BoardEngine::mirrorColumns(Board board)
+{
+    return (board << 48) | ((board & 0x00000000FFFF0000ULL) << 16) |
+           ((board >> 16) & 0x00000000FFFF0000ULL) | (board >> 48);
+}
+
+
+Board BoardEngine::symmetry(Board board, int symmetry)
+{
+    assert(0 <= symmetry && symmetry < SYMMETRIES);
+
+    if (0 != (symmetry & 4)) {
+        board = transpose(board);
+    }
+    if (0 != (symmetry & 1)) {
+        board = mirrorRows(board);
+    }
+    if (0 != (symmetry & 2)) {
+        board = mirrorColumns(board);
+    }
+
+    return board;
+}
+
+
+Direction BoardEngine::symmetryDirection(Direction direction, int symmetry)
+{
+    assert(0 <= symmetry && symmetry < SYMMETRIES);
+
+    if (0 != (symmetry & 4)) {
+        static const Direction transposed[] = { Direction::Up, Direction::Down, Direction::Left, Direction::Right };
+        direction = transposed[int(direction)];
+    }
+    if (0 != (symmetry & 1)) {
+        static const Direction mirrored[] = { Direction::Right, Direction::Left, Direction::Up, Direction::Down };
+        direction = mirrored[int(direction)];
+    }
+    if (0 != (symmetry & 2)) {
+        static const Direction mirrored[] = { Direction::Left, Direction::Right, Direction::Down, Direction::Up };
+        direction = mirrored[int(direction)];
+    }
+
+    return direction;
+}
+
+
+Board BoardEngine::canonical(Board board)
+{
+    int symmetry = 0;
+    return canonical(board, symmetry);
+}
+
+
+Board BoardEngine::canonical(Board board, int &symmetry)
+{
+    const Board transposed = transpose(board);
+    const Board boards[SYMMETRIES] = {
+        board, mirrorRows(board), mirrorColumns(board), mirrorColumns(mirrorRows(board)),
+        transposed, mirrorRows(transposed), mirrorColumns(transposed), mirrorColumns(mirrorRows(transposed))
+    };
+
+    symmetry = 0;
+    for (int i = 1; i < SYMMETRIES; ++i) {
+        if (boards[i] < boards[symmetry]) {
+            symmetry = i;
+        }
+    }
+
+    return boards[symmetry];
+}
+
+
+Directions BoardEngine::directionBit(Direction direction)
+{
+    return Directions(1 << int(direction));
+}
+
+
+Directions BoardEngine::legalMoves(Board board)
+{
+    const std::uint64_t empty = emptyCells(board);
+    const std::uint64_t occupied = ~empty & CELL_LOW_BITS;
+
+    Board full = board & (board >> 2);
+    full &= full >> 1;
+    const std::uint64_t mergeable = occupied & ~full;
+
+    Board horizontal = board ^ (board >> CELL_BITS);
+    horizontal |= horizontal >> 2;
+    horizontal |= horizontal >> 1;
+    const std::uint64_t horizontalPairs = ~horizontal & mergeable & HORIZONTAL_PAIR_BITS;
+
+    Board vertical = board ^ (board >> ROW_BITS);
+    vertical |= vertical >> 2;
+    vertical |= vertical >> 1;
+    const std::uint64_t verticalPairs = ~vertical & mergeable & VERTICAL_PAIR_BITS;
+
+    const std::uint64_t right = occupied >> CELL_BITS;
+    const std::uint64_t bottom = occupied >> ROW_BITS;
+    const std::uint64_t rightEmpty = empty >> CELL_BITS;
+    const std::uint64_t bottomEmpty = empty >> ROW_BITS;
+
+    Directions result = 0;
+
+    if (0 != horizontalPairs || 0 != (empty & right & HORIZONTAL_PAIR_BITS)) {
+        result |= directionBit(Direction::Left);
+    }
+    if (0 != horizontalPairs || 0 != (occupied & rightEmpty & HORIZONTAL_PAIR_BITS)) {
+        result |= directionBit(Direction::Right);
+    }
+    if (0 != verticalPairs || 0 != (empty & bottom & VERTICAL_PAIR_BITS)) {
+        result |= directionBit(Direction::Up);
+    }
+    if (0 != verticalPairs || 0 != (occupied & bottomEmpty & VERTICAL_PAIR_BITS)) {
+        result |= directionBit(Direction::Down);
+    }
+
+    return result;
+}
+
+
+MoveResult BoardEngine::move(Board board, Direction direction)
+{
+    const RowTables &tables = rowTables();
+    const bool columns = (Direction::Up == direction || Direction::Down == direction);
+    const RowMove *table = (Direction::Left == direction || Direction::Up == direction) ? tables.left : tables.right;
+    const Board source = columns ? transpose(board) : board;
+
+    MoveResult result = { 0, 0, 0 };
+
+    for (int row = 0; row < ROWS; ++row) {
+        const int shift = row * ROW_BITS;
+        const RowMove &rowMove = table[(source >> shift) & ROW_MASK];
+        result.board |= Board(rowMove.row) << shift;
+        result.score += int(rowMove.score);
+        result.merges += rowMove.merges;
+    }
+
+    if (columns) {
+        result.board = transpose(result.board);
+    }
+
+    return result;
+}
+
+
+MoveResult BoardEngine::move(Board board, Direction direction, MoveTargets &targets)
+{
+    const RowTables &tables = rowTables();
+    const bool columns = (Direction::Up == direction || Direction::Down == direction);
+    const RowMove *table = (Direction::Left == direction || Direction::Up == direction) ? tables.left : tables.right;
+    const Board source = columns ? transpose(board) : board;
+
+    MoveResult result = { 0, 0, 0 };
+    targets.fill(-1);
+
+    for (int row = 0; row < ROWS; ++row) {
+        const int shift = row * ROW_BITS;
+        const std::uint16_t sourceRow = std::uint16_t((source >> shift) & ROW_MASK);
+        const RowMove &rowMove = table[sourceRow];
+        result.board |= Board(rowMove.row) << shift;
+        result.score += int(rowMove.score);
+        result.merges += rowMove.merges;
+
+        for (int column = 0; column < COLUMNS; ++column) {
+            if (0 == ((sourceRow >> (column * CELL_BITS)) & CELL_MASK)) {
+                continue;
+            }
+
+            const int targetColumn = (rowMove.targets >> (column * TARGET_BITS)) & TARGET_MASK;
+            if (columns) {
+                targets[column * COLUMNS + row] = std::int8_t(targetColumn * COLUMNS + row);
+            } else {
+                targets[row * COLUMNS + column] = std::int8_t(row * COLUMNS + targetColumn);
+            }
+        }
+    }
+
+    if (columns) {
+        result.board = transpose(result.board);
+    }
+
+    return result;
+}
+
+} // namespace Internal
+} // namespace Game
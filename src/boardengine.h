@@ -0,0 +1,121 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef BOARDENGINE_H
+#define BOARDENGINE_H
+
+#include <array>
+#include <cstdint>
+
+
+namespace Game {
+namespace Internal {
+
+class RandomGenerator;
+
+// 4x4 board packed as 16 four-bit exponents, cell N occupies bits [4 * N, 4 * N + 4)
+using Board = std::uint64_t;
+
+enum class Direction
+{
+    Left,
+    Right,
+    Up,
+    Down
+};
+
+struct MoveResult
+{
+    Board board;
+    int score;
+    int merges;
+};
+
+using MoveTargets = std::array<std::int8_t, 16>;
+
+struct Spawn
+{
+    int emptyCellRank;
+    int exponent;
+};
+
+// Bit (1 << Direction) is set for every direction which changes the board
+using Directions = std::uint8_t;
+
+class BoardEngine final
+{
+public:
+    static const int ROWS = 4;
+    static const int COLUMNS = 4;
+    static const int CELLS = ROWS * COLUMNS;
+    // Tiles with the max exponent (32768) are not merged, the nibble can't hold the result
+    static const int MAX_EXPONENT = 15;
+    // Rotations and reflections of the square board
+    static const int SYMMETRIES = 8;
+
+    static int exponent(Board board, int cell);
+    static Board setExponent(Board board, int cell, int exponent);
+    static int maxExponent(Board board);
+
+    // The lowest bit of every empty cell nibble is set
+    static std::uint64_t emptyCells(Board board);
+    static int emptyCellsCount(Board board);
+    static Board spawnTile(Board board, int emptyCellRank, int exponent);
+
+    // The spawn rule of the game, which every player and verifier has to share to play the same games:
+    // the exponent is drawn first, a 4 once in FOUR_TILE_ODDS, then the rank among the empty cells
+    static const std::uint32_t FOUR_TILE_ODDS = 10;
+    static Spawn randomSpawn(int emptyCellsCount, RandomGenerator &random);
+    static Board spawnRandomTile(Board board, RandomGenerator &random);
+    // Row-major byte exponents of a board of any size, returns the cell of the new tile
+    static int spawnRandomTile(std::uint8_t *cells, int cellsCount, RandomGenerator &random);
+
+    static int exponentFromValue(int value);
+    static int valueFromExponent(int exponent);
+
+    static int lineCell(Direction direction, int line, int position);
+
+    static Board transpose(Board board);
+    static Board mirrorRows(Board board);
+    static Board mirrorColumns(Board board);
+
+    // Bit 2 of the symmetry transposes the board, then bit 0 mirrors the rows and bit 1 the columns
+    static Board symmetry(Board board, int symmetry);
+    static Direction symmetryDirection(Direction direction, int symmetry);
+    // The smallest board among the symmetries, the symmetry which gives it is returned too
+    static Board canonical(Board board);
+    static Board canonical(Board board, int &symmetry);
+
+    static Directions directionBit(Direction direction);
+    static Directions legalMoves(Board board);
+
+    static MoveResult move(Board board, Direction direction);
+    static MoveResult move(Board board, Direction direction, MoveTargets &targets);
+
+private:
+    BoardEngine() = delete;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // BOARDENGINE_H
@@ -0,0 +1,120 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef CELLMASK_H
+#define CELLMASK_H
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+
+#include "bitoperations.h"
+
+
+namespace Game {
+namespace Internal {
+
+class CellMask final
+{
+public:
+    static const int MAX_CELLS = 256;
+
+    CellMask() :
+        m_words()
+    {
+    }
+
+    void clear()
+    {
+        m_words.fill(0);
+    }
+
+    void fill(int cells)
+    {
+        assert(0 <= cells && cells <= MAX_CELLS);
+
+        for (int word = 0; word < WORDS; ++word) {
+            const int bits = cells - word * WORD_BITS;
+            if (WORD_BITS <= bits) {
+                m_words[word] = ~std::uint64_t(0);
+            } else if (0 < bits) {
+                m_words[word] = (std::uint64_t(1) << bits) - 1;
+            } else {
+                m_words[word] = 0;
+            }
+        }
+    }
+
+    void set(int cell)
+    {
+        assert(0 <= cell && cell < MAX_CELLS);
+        m_words[cell / WORD_BITS] |= std::uint64_t(1) << (cell % WORD_BITS);
+    }
+
+    void reset(int cell)
+    {
+        assert(0 <= cell && cell < MAX_CELLS);
+        m_words[cell / WORD_BITS] &= ~(std::uint64_t(1) << (cell % WORD_BITS));
+    }
+
+    bool test(int cell) const
+    {
+        assert(0 <= cell && cell < MAX_CELLS);
+        return 0 != (m_words[cell / WORD_BITS] & (std::uint64_t(1) << (cell % WORD_BITS)));
+    }
+
+    int count() const
+    {
+        int result = 0;
+        for (const std::uint64_t word : m_words) {
+            result += popCount(word);
+        }
+        return result;
+    }
+
+    // Cell of the set bit with the given rank
+    int select(int rank) const
+    {
+        assert(0 <= rank && rank < count());
+
+        for (int word = 0; word < WORDS; ++word) {
+            const int bits = popCount(m_words[word]);
+            if (rank < bits) {
+                return word * WORD_BITS + selectBit(m_words[word], rank);
+            }
+            rank -= bits;
+        }
+
+        return -1;
+    }
+
+private:
+    static const int WORD_BITS = 64;
+    static const int WORDS = MAX_CELLS / WORD_BITS;
+
+    std::array<std::uint64_t, WORDS> m_words;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // CELLMASK_H
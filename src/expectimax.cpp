@@ -0,0 +1,350 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "expectimax.h"
+#include "bitoperations.h"
+#include "heuristic.h"
+#include "ntuplenetwork.h"
+#include "threadpool.h"
+#include "transpositiontable.h"
+
+#include <atomic>
+#include <cassert>
+#include <limits>
+#include <vector>
+
+static const double FOUR_TILE_PROBABILITY = 1.0 / Game::Internal::BoardEngine::FOUR_TILE_ODDS;
+static const double TWO_TILE_PROBABILITY = 1.0 - FOUR_TILE_PROBABILITY;
+// Spawn sequences less likely than this are not worth expanding
+static const double MIN_PROBABILITY = 0.0001;
+static const double EMPTY_CELL_VALUE = 16.0;
+// Reading the clock at every node would cost more than the nodes themselves
+static const std::uint64_t DEADLINE_CHECK_NODES = 1024;
+
+
+namespace Game {
+namespace Internal {
+
+namespace {
+
+struct SpawnTask
+{
+    Board board;
+    int move;
+    double weight;
+};
+
+} // namespace
+
+
+Expectimax::Expectimax(ThreadPool *pool) :
+    m_pool(pool),
+    m_table(nullptr),
+    m_network(nullptr),
+    m_heuristic(nullptr),
+    m_stop(nullptr),
+    m_deadline(Clock::time_point::max()),
+    m_stopped(false),
+    m_depth(DEFAULT_DEPTH)
+{
+}
+
+
+int Expectimax::depth() const
+{
+    return m_depth;
+}
+
+
+void Expectimax::setDepth(int depth)
+{
+    assert(0 < depth);
+    m_depth = depth;
+}
+
+
+TranspositionTable *Expectimax::transpositionTable() const
+{
+    return m_table;
+}
+
+
+void Expectimax::setTranspositionTable(TranspositionTable *table)
+{
+    m_table = table;
+}
+
+
+const NTupleNetwork *Expectimax::network() const
+{
+    return m_network;
+}
+
+
+void Expectimax::setNetwork(const NTupleNetwork *network)
+{
+    m_network = network;
+}
+
+
+const Heuristic *Expectimax::heuristic() const
+{
+    return m_heuristic;
+}
+
+
+void Expectimax::setHeuristic(const Heuristic *heuristic)
+{
+    m_heuristic = heuristic;
+}
+
+
+void Expectimax::setStopFlag(const std::atomic<bool> *stop)
+{
+    m_stop = stop;
+}
+
+
+Expectimax::Clock::time_point Expectimax::deadline() const
+{
+    return m_deadline;
+}
+
+
+void Expectimax::setDeadline(Clock::time_point deadline)
+{
+    m_deadline = deadline;
+}
+
+
+SearchResult Expectimax::search(Board board) const
+{
+    return search(board, {{ Direction::Left, Direction::Right, Direction::Up, Direction::Down }});
+}
+
+
+SearchResult Expectimax::search(Board board, const MoveOrder &order) const
+{
+    if (m_table) {
+        m_table->newSearch();
+    }
+
+    m_stopped.store(false, std::memory_order_relaxed);
+
+    SearchResult result;
+    result.legalMoves = BoardEngine::legalMoves(board);
+    result.bestMove = Direction::Left;
+    result.values.fill(std::numeric_limits<double>::lowest());
+    result.nodes = 1;
+    result.complete = true;
+
+    std::array<double, 4> moveScores = {{ 0.0, 0.0, 0.0, 0.0 }};
+    std::vector<SpawnTask> tasks;
+
+    for (const Direction direction : order) {
+        const int move = int(direction);
+        if (0 == (result.legalMoves & BoardEngine::directionBit(direction))) {
+            continue;
+        }
+
+        const MoveResult moved = BoardEngine::move(board, direction);
+        moveScores[move] = moved.score;
+        result.values[move] = 0.0;
+
+        if (1 == m_depth) {
+            tasks.push_back({ moved.board, move, -1.0 });
+            continue;
+        }
+
+        const std::uint64_t empty = BoardEngine::emptyCells(moved.board);
+        const double cellWeight = 1.0 / popCount(empty);
+
+        for (std::uint64_t cells = empty; 0 != cells; cells &= cells - 1) {
+            const int shift = countTrailingZeros(cells);
+            tasks.push_back({ moved.board | (Board(1) << shift), move, cellWeight * TWO_TILE_PROBABILITY });
+            tasks.push_back({ moved.board | (Board(2) << shift), move, cellWeight * FOUR_TILE_PROBABILITY });
+        }
+    }
+
+    if (0 == result.legalMoves) {
+        return result;
+    }
+
+    std::vector<double> values(tasks.size());
+    std::atomic<std::uint64_t> nodes(0);
+
+    const auto runTask = [&](int index) {
+        const SpawnTask &task = tasks[std::size_t(index)];
+        std::uint64_t taskNodes = 0;
+
+        // Small tasks may never count up to a deadline check on their own
+        if (isStopped(0)) {
+            values[std::size_t(index)] = 0.0;
+            return;
+        }
+
+        if (task.weight < 0.0) {
+            values[std::size_t(index)] = leafValue(task.board);
+        } else {
+            values[std::size_t(index)] = task.weight * moveNode(task.board, m_depth - 1, task.weight, taskNodes);
+        }
+
+        nodes.fetch_add(taskNodes + 1, std::memory_order_relaxed);
+    };
+
+    if (m_pool) {
+        m_pool->parallelFor(int(tasks.size()), runTask);
+    } else {
+        for (int index = 0; index < int(tasks.size()); ++index) {
+            runTask(index);
+        }
+    }
+
+    // Summed in task order, so the values don't depend on the threads count
+    for (std::size_t index = 0; index < tasks.size(); ++index) {
+        result.values[std::size_t(tasks[index].move)] += values[index];
+    }
+
+    double bestValue = std::numeric_limits<double>::lowest();
+
+    for (int move = 0; move < 4; ++move) {
+        if (0 == (result.legalMoves & BoardEngine::directionBit(Direction(move)))) {
+            continue;
+        }
+
+        result.values[std::size_t(move)] += moveScores[std::size_t(move)];
+
+        if (bestValue < result.values[std::size_t(move)]) {
+            bestValue = result.values[std::size_t(move)];
+            result.bestMove = Direction(move);
+        }
+    }
+
+    result.nodes += nodes.load();
+    result.complete = !m_stopped.load(std::memory_order_relaxed);
+
+    return result;
+}
+
+
+double Expectimax::evaluate(Board board)
+{
+    return EMPTY_CELL_VALUE * BoardEngine::emptyCellsCount(board);
+}
+
+
+bool Expectimax::isStopped(std::uint64_t nodes) const
+{
+    if (m_stopped.load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    const bool stop = (m_stop && m_stop->load(std::memory_order_relaxed)) ||
+                      (Clock::time_point::max() != m_deadline && 0 == nodes % DEADLINE_CHECK_NODES &&
+                       m_deadline < Clock::now());
+
+    if (stop) {
+        m_stopped.store(true, std::memory_order_relaxed);
+    }
+
+    return stop;
+}
+
+
+double Expectimax::leafValue(Board board) const
+{
+    if (m_network) {
+        return m_network->evaluate(board);
+    }
+
+    return m_heuristic ? double(m_heuristic->evaluate(board)) : evaluate(board);
+}
+
+
+double Expectimax::moveNode(Board board, int depth, double probability, std::uint64_t &nodes) const
+{
+    ++nodes;
+
+    if (isStopped(nodes)) {
+        return 0.0;
+    }
+
+    double result = 0.0;
+
+    for (int move = 0; move < 4; ++move) {
+        const MoveResult moved = BoardEngine::move(board, Direction(move));
+
+        if (moved.board == board) {
+            continue;
+        }
+
+        const double value = moved.score + chanceNode(moved.board, depth - 1, probability, nodes);
+        if (result < value) {
+            result = value;
+        }
+    }
+
+    return result;
+}
+
+
+double Expectimax::chanceNode(Board board, int depth, double probability, std::uint64_t &nodes) const
+{
+    ++nodes;
+
+    const std::uint64_t empty = BoardEngine::emptyCells(board);
+    const int emptyCount = popCount(empty);
+
+    if (depth <= 0 || probability < MIN_PROBABILITY || 0 == emptyCount) {
+        return leafValue(board);
+    }
+
+    // The value of a board doesn't change under rotations and reflections
+    const Board key = m_table ? BoardEngine::canonical(board) : board;
+    float cachedValue = 0.0f;
+    if (m_table && m_table->lookup(key, depth, cachedValue)) {
+        return cachedValue;
+    }
+
+    const double cellProbability = probability / emptyCount;
+    double result = 0.0;
+
+    for (std::uint64_t cells = empty; 0 != cells; cells &= cells - 1) {
+        const int shift = countTrailingZeros(cells);
+        result += TWO_TILE_PROBABILITY *
+                  moveNode(board | (Board(1) << shift), depth, cellProbability * TWO_TILE_PROBABILITY, nodes);
+        result += FOUR_TILE_PROBABILITY *
+                  moveNode(board | (Board(2) << shift), depth, cellProbability * FOUR_TILE_PROBABILITY, nodes);
+    }
+
+    result /= emptyCount;
+
+    // A stopped search leaves partial values behind
+    if (m_table && !m_stopped.load(std::memory_order_relaxed)) {
+        m_table->store(key, depth, float(result));
+    }
+
+    return result;
+}
+
+} // namespace Internal
+} // namespace Game
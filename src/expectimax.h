@@ -0,0 +1,112 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef EXPECTIMAX_H
+#define EXPECTIMAX_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "boardengine.h"
+
+
+namespace Game {
+namespace Internal {
+
+class Heuristic;
+class NTupleNetwork;
+class ThreadPool;
+class TranspositionTable;
+
+struct SearchResult
+{
+    Directions legalMoves;
+    Direction bestMove;
+    // Expected score of every move, including the merges on the way and the leaf evaluation
+    std::array<double, 4> values;
+    std::uint64_t nodes;
+    // False when the search was stopped early, the values are partial then
+    bool complete;
+};
+
+// Depth-limited expectimax over the packed board, new tiles are 2 with 0.9 and 4 with 0.1 probability.
+// The root moves and the spawns below them are searched in parallel when a pool is given.
+// Chance nodes are cached in the transposition table by their canonical board when one is set.
+// The leaves are afterstates, valued by the network or the heuristic when one is set and by the empty cells otherwise.
+class Expectimax final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using MoveOrder = std::array<Direction, 4>;
+
+    static const int DEFAULT_DEPTH = 3;
+
+    explicit Expectimax(ThreadPool *pool = nullptr);
+
+    int depth() const;
+    void setDepth(int depth);
+
+    TranspositionTable *transpositionTable() const;
+    void setTranspositionTable(TranspositionTable *table);
+
+    const NTupleNetwork *network() const;
+    void setNetwork(const NTupleNetwork *network);
+
+    const Heuristic *heuristic() const;
+    void setHeuristic(const Heuristic *heuristic);
+
+    // A search gives up as soon as the flag is raised or the deadline passes
+    void setStopFlag(const std::atomic<bool> *stop);
+    Clock::time_point deadline() const;
+    void setDeadline(Clock::time_point deadline);
+
+    SearchResult search(Board board) const;
+    // The root moves are queued in this order, the likely best one first gets the threads first
+    SearchResult search(Board board, const MoveOrder &order) const;
+
+    static double evaluate(Board board);
+
+private:
+    Expectimax(const Expectimax &) = delete;
+    Expectimax &operator=(const Expectimax &) = delete;
+
+    bool isStopped(std::uint64_t nodes) const;
+    double leafValue(Board board) const;
+    double moveNode(Board board, int depth, double probability, std::uint64_t &nodes) const;
+    double chanceNode(Board board, int depth, double probability, std::uint64_t &nodes) const;
+
+    ThreadPool *const m_pool;
+    TranspositionTable *m_table;
+    const NTupleNetwork *m_network;
+    const Heuristic *m_heuristic;
+    const std::atomic<bool> *m_stop;
+    Clock::time_point m_deadline;
+    mutable std::atomic<bool> m_stopped;
+    int m_depth;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // EXPECTIMAX_H
@@ -39,6 +39,13 @@ static const char *const SCORE_PROPERTY_NAME = "score";
 static const char *const BEST_SCORE_PROPERTY_NAME = "bestScore";
 static const char *const UNDO_BUTTON_ENABLED_PROPERTY_NAME = "undoButtonEnabled";
 static const char *const UNDO_BUTTON_ANIMATION_PROPERTY_NAME = "undoButtonAnimation";
+static const char *const HINT_DIRECTION_PROPERTY_NAME = "hintDirection";
+static const char *const AUTOPLAY_RATE_PROPERTY_NAME = "autoplayRate";
+
+static const char *const LEFT_HINT_DIRECTION_NAME = "left";
+static const char *const RIGHT_HINT_DIRECTION_NAME = "right";
+static const char *const UP_HINT_DIRECTION_NAME = "up";
+static const char *const DOWN_HINT_DIRECTION_NAME = "down";
 
 static const char *const INIT_GAME_STATE_NAME = "init";
 static const char *const PLAY_GAME_STATE_NAME = "play";
@@ -237,6 +244,37 @@ bool Game::isUndoButtonEnabled() const
 }
 
 
+void Game::setHintDirection(MoveDirection direction)
+{
+    QString directionName;
+
+    switch (direction) {
+    case MoveDirection::None:
+        break;
+    case MoveDirection::Left:
+        directionName = QLatin1Literal(LEFT_HINT_DIRECTION_NAME);
+        break;
+    case MoveDirection::Right:
+        directionName = QLatin1Literal(RIGHT_HINT_DIRECTION_NAME);
+        break;
+    case MoveDirection::Up:
+        directionName = QLatin1Literal(UP_HINT_DIRECTION_NAME);
+        break;
+    case MoveDirection::Down:
+        directionName = QLatin1Literal(DOWN_HINT_DIRECTION_NAME);
+        break;
+    }
+
+    d->m_gameItem->setProperty(HINT_DIRECTION_PROPERTY_NAME, directionName);
+}
+
+
+void Game::setAutoplayRate(int rate)
+{
+    d->m_gameItem->setProperty(AUTOPLAY_RATE_PROPERTY_NAME, rate);
+}
+
+
 void Game::showFullScreen()
 {
     Q_ASSERT(nullptr != d->m_windowItem);
@@ -379,6 +417,9 @@ bool Game::eventFilter(QObject *object, QEvent *event)
     if (QEvent::KeyPress == event->type()) {
         QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
 
+        // Whatever the key does, the position the hint is searched for is about to change
+        emit hintCancelRequested();
+
         switch (keyEvent->key()) {
         case Qt::Key_Left:
             emit moveTilesRequested(MoveDirection::Left);
@@ -399,6 +440,19 @@ bool Game::eventFilter(QObject *object, QEvent *event)
         case Qt::Key_Backspace:
             emit undoRequested();
             break;
+        case Qt::Key_H:
+            emit hintRequested();
+            break;
+        case Qt::Key_A:
+            emit autoplayToggleRequested();
+            break;
+        case Qt::Key_Plus:
+        case Qt::Key_Equal:
+            emit autoplayFasterRequested();
+            break;
+        case Qt::Key_Minus:
+            emit autoplaySlowerRequested();
+            break;
         default:
             break;
         }
@@ -419,6 +473,7 @@ void Game::onRootObjectCreated(QObject *object, const QUrl &url)
     connect(d->m_gameItem, SIGNAL(continueGameRequested()), this, SIGNAL(continueGameRequested()));
     connect(d->m_gameItem, SIGNAL(startNewGameRequested()), this, SIGNAL(startNewGameRequested()));
     connect(d->m_gameItem, SIGNAL(undoRequested()), this, SIGNAL(undoRequested()));
+    connect(d->m_gameItem, SIGNAL(hintRequested()), this, SIGNAL(hintRequested()));
 
     QQuickItem *gameboardItem = q_check_ptr(d->m_gameItem->findChild<QQuickItem*>(QLatin1Literal(GAMEBOARD_OBJECT_NAME)));
     d->m_gameboard = std::make_unique<Gameboard>(gameboardItem);
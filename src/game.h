@@ -78,6 +78,10 @@ public:
     void setUndoButtonEnabled(bool enabled, bool animation = true);
     bool isUndoButtonEnabled() const;
 
+    void setHintDirection(MoveDirection direction);
+    // Zero hides the autoplay rate
+    void setAutoplayRate(int rate);
+
 signals:
     void gameReady();
     void scoreChanged(int score);
@@ -90,6 +94,11 @@ signals:
     void startNewGameRequested();
     void continueGameRequested();
     void undoRequested();
+    void hintRequested();
+    void hintCancelRequested();
+    void autoplayToggleRequested();
+    void autoplayFasterRequested();
+    void autoplaySlowerRequested();
     void moveTilesRequested(MoveDirection moveDirection);
 
 public slots:
@@ -20,13 +20,20 @@
 ***************************************************************************/
 
 
+#include "boardengine.h"
 #include "cell.h"
+#include "cellmask.h"
 #include "game.h"
 #include "gamecontroller.h"
+#include "hintengine.h"
+#include "movekernel.h"
+#include "randomgenerator.h"
 #include "storage.h"
 #include "tile.h"
+#include "undobuffer.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlComponent>
@@ -36,8 +43,7 @@
 #include <QTimer>
 
 #include <algorithm>
-#include <cmath>
-#include <random>
+#include <vector>
 
 static const int SHOW_START_TILES_DELAY = 400;
 
@@ -45,6 +51,7 @@ static const char *const GAME_WINDOW_X_SETTING_KEY_NAME = "x";
 static const char *const GAME_WINDOW_Y_SETTING_KEY_NAME = "y";
 static const char *const GAME_WINDOW_WIDTH_SETTING_KEY_NAME = "width";
 static const char *const GAME_WINDOW_HEIGHT_SETTING_KEY_NAME = "height";
+static const char *const AUTOPLAY_RATE_SETTING_KEY_NAME = "autoplayRate";
 #ifdef Q_OS_MACOS
 static const char *const SETTINGS_FILE_LOCATION = "%1/../Resources/settings.ini";
 #endif
@@ -52,6 +59,16 @@ static const char *const TILE_FILE_PATH = "qrc:/qml/Tile.qml";
 static const int DEFAULT_GAMEBOARD_ROWS = 4;
 static const int DEFAULT_GAMEBOARD_COLUMNS = 4;
 static const int START_TILES_COUNT = 2;
+static const int UNDO_TURNS_COUNT = 64;
+static const int HINT_TIME_BUDGET = 200;
+// Moves per second
+static const int AUTOPLAY_RATES[] = { 1, 2, 4, 8, 16, 32, 64, 125, 250, 500, 1000, 2000, 4000 };
+static const int AUTOPLAY_RATES_COUNT = int(sizeof(AUTOPLAY_RATES) / sizeof(AUTOPLAY_RATES[0]));
+static const int DEFAULT_AUTOPLAY_RATE_INDEX = 4;
+// Faster autoplay skips the tile animations, so only the state a frame ends with is drawn
+static const int MAX_ANIMATED_AUTOPLAY_RATE = 8;
+static const qint64 NSECS_PER_SECOND = 1000000000;
+static const qint64 NSECS_PER_MSEC = 1000000;
 static const int WINNING_VALUE = 2048;
 
 static const int FIRST_TURN_ID = 1;
@@ -60,8 +77,10 @@ static const int FIRST_PARENT_TURN_ID = 0;
 
 namespace Game {
 
+using Board = Internal::Board;
 using Game = Internal::Game;
 using GameState = Internal::GameState;
+using HintEngine = Internal::HintEngine;
 using Storage = Internal::Storage;
 using StorageState = Internal::Storage::StorageState;
 using Tile = Internal::Tile;
@@ -69,6 +88,26 @@ using Tile_ptr = Internal::Tile_ptr;
 
 namespace Internal {
 
+static Direction toBoardDirection(MoveDirection direction)
+{
+    switch (direction) {
+    case MoveDirection::Left:
+        return Direction::Left;
+    case MoveDirection::Right:
+        return Direction::Right;
+    case MoveDirection::Up:
+        return Direction::Up;
+    case MoveDirection::Down:
+        return Direction::Down;
+    case MoveDirection::None:
+        break;
+    }
+
+    Q_ASSERT(false);
+    return Direction::Left;
+}
+
+
 struct TileData
 {
     int id;
@@ -81,7 +120,7 @@ class GameControllerPrivate final
 public:
     explicit GameControllerPrivate(GameController *parent);
 
-    qreal random();
+    void seedRandom();
     int nextTileId();
     bool useRestoreAnimation() const;
     void createTile(int value, int cell);
@@ -90,12 +129,30 @@ public:
     void createStartTiles();
     void hideTile(const Tile_ptr &tile, bool animation = true);
     void moveTile(const Cell_ptr &sourceCell, const Cell_ptr &targetCell);
+    void mergeTile(const Cell_ptr &sourceCell, const Cell_ptr &targetCell);
+    void setMoveAnimation(bool enabled);
+    void moveTiles(MoveDirection direction);
+    void finishMove();
+    void applyEvents();
+    void applyEvent(const MoveEvent &event);
+    bool packBoard(Board &board) const;
+    bool packHintBoard(Board &board) const;
     void clearTiles();
+    void pushUndoTurn();
+    void undoTurn();
+    Directions legalMoves() const;
+    bool canMove(MoveDirection direction) const;
     bool isDefeat() const;
+    void cancelHint();
+    int autoplayRate() const;
+    void setAutoplayRateIndex(int index);
+    void startAutoplay();
+    void stopAutoplay();
+    void requestAutoplayMove();
+    static bool isGameboardSizeSupported(int rows, int columns);
     void setGameboardSize(int rows, int columns);
     void createNewGame(int rows, int columns);
     void saveTurn();
-    bool isFirstTurn() const;
     QVariantList tilesToList() const;
     QVariantMap tileToMap(const Tile_ptr &tile) const;
     TileData tileFromVariant(const QVariant &tile) const;
@@ -107,9 +164,12 @@ public:
     const std::unique_ptr<QQmlComponent> m_tileQmlComponent;
     const std::unique_ptr<Game> m_game;
     const std::unique_ptr<Storage> m_storage;
+    const std::unique_ptr<HintEngine> m_hintEngine;
     const std::unique_ptr<QSettings> m_settings;
-    std::mt19937 m_randomEngine;
-    std::uniform_real_distribution<> m_randomDistribution;
+    const std::unique_ptr<QTimer> m_autoplayTimer;
+    QElapsedTimer m_autoplayClock;
+    std::uint64_t m_seed;
+    RandomGenerator m_random;
     QList<Cell_ptr> m_cells;
     QList<Tile_ptr> m_tiles;
     QList<Tile_ptr> m_aboutToHiddenTiles;
@@ -121,8 +181,20 @@ public:
     int m_turnIdSequence;
     int m_tileId;
     int m_movingTilesCount;
+    int m_moveScore;
+    std::vector<std::uint8_t> m_exponents;
+    std::vector<std::int16_t> m_targets;
+    MoveEvents m_moveEvents;
+    std::vector<std::int32_t> m_tileIds;
+    UndoBuffer m_undoBuffer;
+    CellMask m_emptyCells;
+    MoveKernel m_moveKernel;
     MoveDirection m_moveDirection;
-    bool m_undoEnabled;
+    MoveDirection m_autoplayMove;
+    int m_autoplayRateIndex;
+    bool m_autoplay;
+    bool m_moveAnimation;
+    bool m_win;
     bool m_undoStarted;
     bool m_moveBlocked;
 };
@@ -134,31 +206,42 @@ GameControllerPrivate::GameControllerPrivate(GameController *parent) :
     m_tileQmlComponent(std::make_unique<QQmlComponent>(m_qmlEngine.get(), QUrl(QLatin1Literal(TILE_FILE_PATH)))),
     m_game(std::make_unique<Game>(m_qmlEngine.get(), parent)),
     m_storage(std::make_unique<Storage>(parent)),
+    m_hintEngine(std::make_unique<HintEngine>(parent)),
 #ifdef Q_OS_MACOS
     m_settings(std::make_unique<QSettings>(QString(QLatin1Literal(SETTINGS_FILE_LOCATION))
                                            .arg(QCoreApplication::applicationDirPath()), QSettings::IniFormat)),
 #else
     m_settings(std::make_unique<QSettings>()),
 #endif
-  m_randomEngine(std::random_device()()),
-  m_randomDistribution(0.0, 1.0),
+  m_autoplayTimer(std::make_unique<QTimer>()),
+  m_seed(RandomGenerator::randomSeed()),
+  m_random(m_seed),
   m_gameId(0),
   m_turnId(0),
   m_parentTurnId(0),
   m_turnIdSequence(0),
   m_tileId(0),
   m_movingTilesCount(0),
+  m_moveScore(0),
+  m_undoBuffer(UNDO_TURNS_COUNT),
+  m_moveKernel(nullptr),
   m_moveDirection(MoveDirection::None),
-  m_undoEnabled(true),
+  m_autoplayMove(MoveDirection::None),
+  m_autoplayRateIndex(DEFAULT_AUTOPLAY_RATE_INDEX),
+  m_autoplay(false),
+  m_moveAnimation(true),
+  m_win(false),
   m_undoStarted(false),
   m_moveBlocked(true)
 {
+    m_autoplayTimer->setSingleShot(true);
 }
 
 
-qreal GameControllerPrivate::random()
+// Every turn draws from its own stream of the game seed, so the spawns can be replayed
+void GameControllerPrivate::seedRandom()
 {
-    return m_randomDistribution(m_randomEngine);
+    m_random.seed(m_seed, std::uint64_t(m_turnId));
 }
 
 
@@ -177,7 +260,7 @@ bool GameControllerPrivate::useRestoreAnimation() const
 void GameControllerPrivate::createTile(int value, int cell)
 {
     const int id = nextTileId();
-    createTile(id, value, cell, true);
+    createTile(id, value, cell, m_moveAnimation);
 }
 
 
@@ -197,25 +280,24 @@ void GameControllerPrivate::createTile(int id, int value, int cell, bool animati
 
     m_tiles.append(tile);
 
+    tile->setMoveAnimationEnabled(m_moveAnimation);
     tile->setCell(m_cells.at(cell));
     tile->show(animation);
+
+    m_exponents[cell] = std::uint8_t(BoardEngine::exponentFromValue(value));
+    m_emptyCells.reset(cell);
 }
 
 
 void GameControllerPrivate::createRandomTile()
 {
-    QList<int> cells;
+    const int emptyCellsCount = m_emptyCells.count();
+    Q_ASSERT(0 < emptyCellsCount);
 
-    for (const auto &cell : m_cells) {
-        if (!cell->tile()) {
-            cells.append(cell->index());
-        }
-    }
-
-    const int value = random() < 0.9 ? 2 : 4;
-    const int cell = cells.at(int(std::floor(random() * (cells.size() - 1))));
+    const Spawn spawn = BoardEngine::randomSpawn(emptyCellsCount, m_random);
+    const int cell = m_emptyCells.select(spawn.emptyCellRank);
 
-    createTile(value, cell);
+    applyEvent({ MoveEventType::Spawn, std::uint8_t(spawn.exponent), -1, -1, std::int16_t(cell) });
 }
 
 
@@ -257,54 +339,223 @@ void GameControllerPrivate::moveTile(const Cell_ptr &sourceCell, const Cell_ptr
 }
 
 
-void GameControllerPrivate::clearTiles()
+void GameControllerPrivate::mergeTile(const Cell_ptr &sourceCell, const Cell_ptr &targetCell)
+{
+    Q_ASSERT(sourceCell);
+    Q_ASSERT(targetCell);
+
+    const auto &tile = sourceCell->tile();
+    const auto &targetTile = targetCell->tile();
+    Q_ASSERT(tile);
+    Q_ASSERT(targetTile);
+    Q_ASSERT(tile->value() == targetTile->value());
+
+    tile->setValue(tile->value() * 2);
+    tile->setZ(targetTile->z() + 1);
+
+    if (WINNING_VALUE == tile->value() && GameState::Continue != m_game->gameState()) {
+        m_win = true;
+    }
+
+    m_aboutToHiddenTiles.append(targetTile);
+    m_tiles.removeOne(targetTile);
+    targetTile->setCell(nullptr);
+    targetCell->setTile(nullptr);
+    moveTile(sourceCell, targetCell);
+    m_moveScore += tile->value();
+}
+
+
+void GameControllerPrivate::setMoveAnimation(bool enabled)
 {
+    if (m_moveAnimation == enabled) {
+        return;
+    }
+
+    m_moveAnimation = enabled;
+
     for (const auto &tile : m_tiles) {
+        tile->setMoveAnimationEnabled(enabled);
+    }
+
+    for (const auto &tile : m_hiddenTiles) {
+        tile->setMoveAnimationEnabled(enabled);
+    }
+}
+
+
+void GameControllerPrivate::moveTiles(MoveDirection direction)
+{
+    Q_ASSERT(0 == m_movingTilesCount);
+
+    m_moveScore = 0;
+
+    const Direction boardDirection = toBoardDirection(direction);
+    int score = 0;
+    Board board = 0;
+
+    if (packBoard(board)) {
+        MoveTargets targets;
+        const MoveResult result = BoardEngine::move(board, boardDirection, targets);
+
+        if (result.board == board) {
+            return;
+        }
+
+        std::copy(targets.cbegin(), targets.cend(), m_targets.begin());
+        for (int cell = 0; cell < BoardEngine::CELLS; ++cell) {
+            m_exponents[cell] = std::uint8_t(BoardEngine::exponent(result.board, cell));
+        }
+
+        score = result.score;
+    } else {
+        const KernelResult result = m_moveKernel(m_exponents.data(), m_game->gameboardRows(),
+                                                 m_game->gameboardColumns(), boardDirection, m_targets.data());
+
+        if (0 == result.moves) {
+            return;
+        }
+
+        score = result.score;
+    }
+
+    MoveKernels::moveEvents(m_targets.data(), m_exponents.data(), m_game->gameboardRows(),
+                            m_game->gameboardColumns(), boardDirection, m_moveEvents);
+    applyEvents();
+
+    Q_ASSERT(score == m_moveScore);
+    Q_UNUSED(score)
+}
+
+
+void GameControllerPrivate::finishMove()
+{
+    for (const auto &tile : m_aboutToHiddenTiles) {
         hideTile(tile, false);
     }
 
-    m_tiles.clear();
+    m_aboutToHiddenTiles.clear();
+    m_game->setScore(m_game->score() + m_moveScore);
+
+    bool moveBlocked = false;
+
+    if (m_win) {
+        m_game->setGameState(GameState::Win);
+        moveBlocked = true;
+        m_win = false;
+    } else {
+        createRandomTile();
+    }
+
+    if (isDefeat()) {
+        m_game->setGameState(GameState::Defeat);
+        moveBlocked = true;
+    }
+
+    if (StorageState::Ready == m_storage->state()) {
+        saveTurn();
+    }
+
+    if (!moveBlocked) {
+        m_moveBlocked = false;
+
+        if (!m_game->isUndoButtonEnabled()) {
+            m_game->setUndoButtonEnabled(true);
+        }
+    }
+
+    if (!m_autoplay) {
+        return;
+    }
+
+    switch (m_game->gameState()) {
+    case GameState::Defeat:
+        stopAutoplay();
+        break;
+    case GameState::Win:
+        q->onContinueGameRequested();
+        requestAutoplayMove();
+        break;
+    default:
+        requestAutoplayMove();
+        break;
+    }
 }
 
 
-bool GameControllerPrivate::isDefeat() const
+void GameControllerPrivate::applyEvents()
 {
-    if (m_tiles.size() < m_cells.size()) {
+    for (const MoveEvent &event : m_moveEvents) {
+        applyEvent(event);
+    }
+
+    m_moveEvents.clear();
+}
+
+
+void GameControllerPrivate::applyEvent(const MoveEvent &event)
+{
+    switch (event.type) {
+    case MoveEventType::Slide: {
+        const auto &cell = m_cells.at(event.source);
+        cell->tile()->setZ(0);
+        moveTile(cell, m_cells.at(event.target));
+        m_emptyCells.set(event.source);
+        break;
+    }
+    case MoveEventType::Merge: {
+        const auto &cell = m_cells.at(event.source);
+        const auto &targetCell = m_cells.at(event.target);
+        if (cell != targetCell) {
+            cell->tile()->setZ(0);
+            moveTile(cell, targetCell);
+        }
+        mergeTile(m_cells.at(event.partner), targetCell);
+        m_emptyCells.set(event.source);
+        m_emptyCells.set(event.partner);
+        break;
+    }
+    case MoveEventType::Spawn:
+        createTile(BoardEngine::valueFromExponent(event.exponent), event.target);
+        break;
+    }
+
+    m_emptyCells.reset(event.target);
+}
+
+
+bool GameControllerPrivate::packBoard(Board &board) const
+{
+    if (BoardEngine::ROWS != m_game->gameboardRows() || BoardEngine::COLUMNS != m_game->gameboardColumns()) {
         return false;
     }
 
+    return packHintBoard(board);
+}
+
+
+// Smaller boards than 4x4 sit in the top left corner of the packed board
+bool GameControllerPrivate::packHintBoard(Board &board) const
+{
     const int rows = m_game->gameboardRows();
     const int columns = m_game->gameboardColumns();
 
-    const int latestRow = rows - 1;
-    const int latestColumn = columns - 1;
+    if (BoardEngine::ROWS < rows || BoardEngine::COLUMNS < columns) {
+        return false;
+    }
 
-    Cell_ptr cell;
+    board = 0;
 
     for (int row = 0; row < rows; ++row) {
         for (int column = 0; column < columns; ++column) {
-            const int cellIndex = row * columns + column;
-            cell = m_cells.at(cellIndex);
-            Q_ASSERT(cell->tile());
-            const int value = cell->tile()->value();
-
-            if (column < latestColumn) {
-                const int rightCellIndex = cellIndex + 1;
-                cell = m_cells.at(rightCellIndex);
-                Q_ASSERT(cell->tile());
-                if (value == cell->tile()->value()) {
-                    return false;
-                }
-            }
+            const int exponent = m_exponents[std::size_t(row * columns + column)];
 
-            if (row < latestRow) {
-                const int bottomCellIndex = cellIndex + columns;
-                cell = m_cells.at(bottomCellIndex);
-                Q_ASSERT(cell->tile());
-                if (value == cell->tile()->value()) {
-                    return false;
-                }
+            // Tiles which the packed board can't merge are left for the cell kernels
+            if (BoardEngine::MAX_EXPONENT <= exponent) {
+                return false;
             }
+
+            board = BoardEngine::setExponent(board, row * BoardEngine::COLUMNS + column, exponent);
         }
     }
 
@@ -312,20 +563,177 @@ bool GameControllerPrivate::isDefeat() const
 }
 
 
+void GameControllerPrivate::clearTiles()
+{
+    for (const auto &tile : m_tiles) {
+        hideTile(tile, false);
+    }
+
+    m_tiles.clear();
+    std::fill(m_exponents.begin(), m_exponents.end(), 0);
+    m_emptyCells.fill(int(m_exponents.size()));
+}
+
+
+void GameControllerPrivate::pushUndoTurn()
+{
+    std::fill(m_tileIds.begin(), m_tileIds.end(), 0);
+
+    for (const auto &tile : m_tiles) {
+        m_tileIds[std::size_t(tile->cell()->index())] = tile->id();
+    }
+
+    m_undoBuffer.push({ m_turnId, m_parentTurnId, m_game->score() }, m_exponents.data(), m_tileIds.data());
+}
+
+
+void GameControllerPrivate::undoTurn()
+{
+    Q_ASSERT(!m_undoBuffer.isEmpty());
+
+    const UndoTurn &turn = m_undoBuffer.top();
+    const std::uint8_t *exponents = m_undoBuffer.topExponents();
+    const std::int32_t *tileIds = m_undoBuffer.topTileIds();
+
+    clearTiles();
+
+    for (int cell = 0; cell < int(m_exponents.size()); ++cell) {
+        if (0 != exponents[cell]) {
+            createTile(tileIds[cell], BoardEngine::valueFromExponent(exponents[cell]), cell, false);
+        }
+    }
+
+    m_turnId = turn.turnId;
+    m_parentTurnId = turn.parentTurnId;
+    m_game->setScore(turn.score);
+    m_undoBuffer.pop();
+}
+
+
+Directions GameControllerPrivate::legalMoves() const
+{
+    Board board = 0;
+    if (packBoard(board)) {
+        return BoardEngine::legalMoves(board);
+    }
+
+    return MoveKernels::legalMoves(m_exponents.data(), m_game->gameboardRows(), m_game->gameboardColumns());
+}
+
+
+bool GameControllerPrivate::canMove(MoveDirection direction) const
+{
+    return 0 != (legalMoves() & BoardEngine::directionBit(toBoardDirection(direction)));
+}
+
+
+bool GameControllerPrivate::isDefeat() const
+{
+    if (m_tiles.size() < m_cells.size()) {
+        return false;
+    }
+
+    return 0 == legalMoves();
+}
+
+
+void GameControllerPrivate::cancelHint()
+{
+    m_hintEngine->cancel();
+    m_autoplayTimer->stop();
+    m_game->setHintDirection(MoveDirection::None);
+}
+
+
+int GameControllerPrivate::autoplayRate() const
+{
+    return AUTOPLAY_RATES[m_autoplayRateIndex];
+}
+
+
+void GameControllerPrivate::setAutoplayRateIndex(int index)
+{
+    m_autoplayRateIndex = std::max(0, std::min(index, AUTOPLAY_RATES_COUNT - 1));
+
+    if (m_autoplay) {
+        m_game->setAutoplayRate(autoplayRate());
+    }
+}
+
+
+void GameControllerPrivate::startAutoplay()
+{
+    if (m_autoplay) {
+        return;
+    }
+
+    m_autoplay = true;
+    m_game->setAutoplayRate(autoplayRate());
+    m_autoplayClock.start();
+    requestAutoplayMove();
+}
+
+
+void GameControllerPrivate::stopAutoplay()
+{
+    m_autoplay = false;
+    cancelHint();
+    m_game->setAutoplayRate(0);
+}
+
+
+// The hint engine picks the autoplay moves, so the search never runs on the GUI thread
+void GameControllerPrivate::requestAutoplayMove()
+{
+    if (!m_autoplay || m_moveBlocked) {
+        return;
+    }
+
+    Board board = 0;
+    if (!packHintBoard(board)) {
+        qWarning() << "Autoplay needs a board up to 4x4";
+        stopAutoplay();
+        return;
+    }
+
+    // The search gets the time one move has at this rate. Above 1000 moves/s that is no time,
+    // and a zero budget asks for a depth 1 move without waiting on a deadline
+    m_hintEngine->requestHint(board, m_game->gameboardRows(), m_game->gameboardColumns(),
+                              std::min(HINT_TIME_BUDGET, 1000 / autoplayRate()));
+}
+
+
+// The empty cells are tracked in a CellMask, which caps the board at 16x16 cells
+bool GameControllerPrivate::isGameboardSizeSupported(int rows, int columns)
+{
+    return 0 < rows && 0 < columns && rows <= CellMask::MAX_CELLS / columns;
+}
+
+
 void GameControllerPrivate::setGameboardSize(int rows, int columns)
 {
+    Q_ASSERT(isGameboardSizeSupported(rows, columns));
+
     m_game->setGameboardSize(rows, columns);
     m_cells = m_game->cells();
+    m_exponents.assign(std::size_t(rows * columns), 0);
+    m_targets.assign(std::size_t(rows * columns), -1);
+    m_emptyCells.fill(rows * columns);
+    m_tileIds.assign(std::size_t(rows * columns), 0);
+    m_undoBuffer.reset(rows * columns);
+    m_moveKernel = MoveKernels::kernel(rows, columns);
 }
 
 
 void GameControllerPrivate::createNewGame(int rows, int columns)
 {
+    stopAutoplay();
     setGameboardSize(rows, columns);
+    m_seed = RandomGenerator::randomSeed();
 
     switch (m_storage->state()) {
     case StorageState::Ready:
-        m_storage->createGame(rows, columns);
+        m_storage->createGame(rows, columns, qint64(m_seed));
         break;
     case StorageState::Error:
         q->startNewGame();
@@ -356,12 +764,6 @@ void GameControllerPrivate::saveTurn()
 }
 
 
-bool GameControllerPrivate::isFirstTurn() const
-{
-    return FIRST_TURN_ID == m_turnId;
-}
-
-
 QVariantList GameControllerPrivate::tilesToList() const
 {
     QVariantList tiles;
@@ -408,6 +810,12 @@ TileData GameControllerPrivate::tileFromVariant(const QVariant &tile) const
 
 void GameControllerPrivate::readSettings()
 {
+    if (m_settings->contains(QLatin1Literal(AUTOPLAY_RATE_SETTING_KEY_NAME))) {
+        const int rate = m_settings->value(QLatin1Literal(AUTOPLAY_RATE_SETTING_KEY_NAME)).toInt();
+        const auto it = std::lower_bound(std::begin(AUTOPLAY_RATES), std::end(AUTOPLAY_RATES), rate);
+        setAutoplayRateIndex(int(it - std::begin(AUTOPLAY_RATES)));
+    }
+
     if (!m_settings->contains(QLatin1Literal(GAME_WINDOW_X_SETTING_KEY_NAME))) {
         // Move game window to center of screen
         QRect rect = m_game->geometry();
@@ -434,6 +842,8 @@ void GameControllerPrivate::saveSettings()
     m_settings->setValue(QLatin1Literal(GAME_WINDOW_Y_SETTING_KEY_NAME), rect.y());
     m_settings->setValue(QLatin1Literal(GAME_WINDOW_WIDTH_SETTING_KEY_NAME), rect.width());
     m_settings->setValue(QLatin1Literal(GAME_WINDOW_HEIGHT_SETTING_KEY_NAME), rect.height());
+
+    m_settings->setValue(QLatin1Literal(AUTOPLAY_RATE_SETTING_KEY_NAME), autoplayRate());
 }
 
 } // namespace Internal
@@ -448,15 +858,20 @@ GameController::GameController(QObject *parent) :
     connect(d->m_game.get(), &Game::startNewGameRequested, this, &GameController::onStartNewGameRequested);
     connect(d->m_game.get(), &Game::continueGameRequested, this, &GameController::onContinueGameRequested);
     connect(d->m_game.get(), &Game::undoRequested, this, &GameController::onUndoRequested);
+    connect(d->m_game.get(), &Game::hintRequested, this, &GameController::onHintRequested);
+    connect(d->m_game.get(), &Game::hintCancelRequested, this, &GameController::onHintCancelRequested);
+    connect(d->m_game.get(), &Game::autoplayToggleRequested, this, &GameController::onAutoplayToggleRequested);
+    connect(d->m_game.get(), &Game::autoplayFasterRequested, this, &GameController::onAutoplayFasterRequested);
+    connect(d->m_game.get(), &Game::autoplaySlowerRequested, this, &GameController::onAutoplaySlowerRequested);
+    connect(d->m_hintEngine.get(), &HintEngine::hintFound, this, &GameController::onHintFound);
+    connect(d->m_autoplayTimer.get(), &QTimer::timeout, this, &GameController::onAutoplayTimeout);
     connect(d->m_storage.get(), &Storage::storageReady, this, &GameController::onStorageReady);
     connect(d->m_storage.get(), &Storage::storageError, this, &GameController::onStorageError);
     connect(d->m_storage.get(), &Storage::gameCreated, this, &GameController::onGameCreated);
     connect(d->m_storage.get(), &Storage::createGameError, this, &GameController::onCreateGameError);
     connect(d->m_storage.get(), &Storage::gameRestored, this, &GameController::onGameRestored);
     connect(d->m_storage.get(), &Storage::restoreGameError, this, &GameController::onRestoreGameError);
-    connect(d->m_storage.get(), &Storage::turnSaved, this, &GameController::onTurnSaved);
     connect(d->m_storage.get(), &Storage::saveTurnError, this, &GameController::onSaveTurnError);
-    connect(d->m_storage.get(), &Storage::turnUndid, this, &GameController::onTurnUndid);
     connect(d->m_storage.get(), &Storage::undoTurnError, this, &GameController::onUndoTurnError);
 }
 
@@ -520,224 +935,147 @@ void GameController::onContinueGameRequested()
 
 void GameController::onUndoRequested()
 {
-    if (!d->m_moveBlocked && d->m_undoEnabled && !d->isFirstTurn()) {
-        d->m_moveBlocked = true;
-        d->m_storage->undoTurn(d->m_turnId);
+    if (d->m_moveBlocked || d->m_undoBuffer.isEmpty()) {
+        return;
+    }
+
+    const int turnId = d->m_turnId;
+
+    d->stopAutoplay();
+    d->undoTurn();
+    // The next move takes the undone id back and replays its spawn stream. Saving it rewrites the stored
+    // turn, so a turn the storage failed to undo is replaced instead of colliding with the new one
+    d->m_turnIdSequence = d->m_turnId;
+    d->m_game->setUndoButtonEnabled(!d->m_undoBuffer.isEmpty());
+
+    if (StorageState::Ready == d->m_storage->state()) {
+        d->m_storage->undoTurn(turnId);
     }
 }
 
 
-void GameController::onMoveTilesRequested(MoveDirection direction)
+void GameController::onHintRequested()
 {
-    if (d->m_moveBlocked || MoveDirection::None == direction) {
+    Board board = 0;
+    if (d->m_autoplay || d->m_moveBlocked || !d->packHintBoard(board)) {
         return;
     }
 
-    d->m_moveBlocked = true;
-    d->m_moveDirection = direction;
+    d->m_game->setHintDirection(MoveDirection::None);
+    d->m_hintEngine->requestHint(board, d->m_game->gameboardRows(), d->m_game->gameboardColumns(), HINT_TIME_BUDGET);
+}
 
-    int rows = 0;
-    int columns = 0;
 
-    switch (direction) {
-    case MoveDirection::Left:
-    case MoveDirection::Right:
-        rows = d->m_game->gameboardRows();
-        columns = d->m_game->gameboardColumns();
-        break;
-    case MoveDirection::Up:
-    case MoveDirection::Down:
-        rows = d->m_game->gameboardColumns();
-        columns = d->m_game->gameboardRows();
-        break;
-    case MoveDirection::None:
-        Q_ASSERT(false);
-        d->m_moveBlocked = false;
-        return;
-    }
+void GameController::onHintCancelRequested()
+{
+    d->cancelHint();
+    d->requestAutoplayMove();
+}
 
-    for (int row = 0; row < rows; ++row) {
-        int firstCellIndex = 0;
-        int neighborCellsIndexDelta = 0;
-
-        switch (direction) {
-        case MoveDirection::Left:
-            firstCellIndex = row * columns;
-            neighborCellsIndexDelta = 1;
-            break;
-        case MoveDirection::Right:
-            firstCellIndex = row * columns + columns - 1;
-            neighborCellsIndexDelta = 1;
-            break;
-        case MoveDirection::Up:
-            firstCellIndex = row;
-            neighborCellsIndexDelta = rows;
-            break;
-        case MoveDirection::Down:
-            firstCellIndex = columns * (rows - 1) + row;
-            neighborCellsIndexDelta = rows;
-            break;
-        case MoveDirection::None:
-            Q_ASSERT(false);
-            break;
+
+void GameController::onHintFound(MoveDirection direction)
+{
+    if (d->m_autoplay) {
+        // Lost boards and small boards without a tablebase have no move to play
+        if (MoveDirection::None == direction) {
+            d->stopAutoplay();
+            return;
         }
 
-        int previousCellIndex = firstCellIndex;
-
-        for (int column = 1; column < columns; ++column) {
-            int cellIndex = 0;
-            switch (direction) {
-            case MoveDirection::Left:
-                cellIndex = firstCellIndex + column;
-                break;
-            case MoveDirection::Right:
-                cellIndex = firstCellIndex - column;
-                break;
-            case MoveDirection::Up:
-                cellIndex = column * rows + row;
-                break;
-            case MoveDirection::Down:
-                cellIndex = columns * (rows - 1) - column * rows + row;
-                break;
-            case MoveDirection::None:
-                Q_ASSERT(false);
-                break;
-            }
+        d->m_autoplayMove = direction;
 
-            const auto &cell = d->m_cells.at(cellIndex);
+        // Waits out the rest of the move interval, faster rates than the search allows just play at once
+        const qint64 interval = NSECS_PER_SECOND / d->autoplayRate();
+        const qint64 remaining = (interval - d->m_autoplayClock.nsecsElapsed()) / NSECS_PER_MSEC;
 
-            if (!cell->tile()) {
-                continue;
-            }
+        if (0 < remaining) {
+            d->m_autoplayTimer->start(int(remaining));
+        } else {
+            onAutoplayTimeout();
+        }
 
-            auto previousCell = d->m_cells.at(previousCellIndex);
-            if (!previousCell->tile()) {
-                const auto &tile = cell->tile();
-                tile->setZ(0);
-                d->moveTile(cell, previousCell);
-                continue;
-            }
+        return;
+    }
 
-            if (previousCell->tile()->value() == cell->tile()->value()) {
-                const auto &tile = cell->tile();
-                tile->setValue(tile->value() * 2);
-                tile->setZ(previousCell->tile()->z() + 1);
-                d->m_aboutToHiddenTiles.append(previousCell->tile());
-                d->m_tiles.removeOne(previousCell->tile());
-                previousCell->tile()->setCell(nullptr);
-                previousCell->setTile(nullptr);
-                d->moveTile(cell, previousCell);
-                switch (direction) {
-                case MoveDirection::Left:
-                    ++previousCellIndex;
-                    break;
-                case MoveDirection::Right:
-                    --previousCellIndex;
-                    break;
-                case MoveDirection::Up:
-                    previousCellIndex += rows;
-                    break;
-                case MoveDirection::Down:
-                    previousCellIndex -= rows;
-                    break;
-                case MoveDirection::None:
-                    Q_ASSERT(false);
-                    break;
-                }
-                continue;
-            }
+    if (!d->m_moveBlocked) {
+        d->m_game->setHintDirection(direction);
+    }
+}
 
-            int cellsIndexDelta = 0;
-            switch (direction) {
-            case MoveDirection::Left:
-            case MoveDirection::Up:
-                cellsIndexDelta = cellIndex - previousCellIndex;
-                break;
-            case MoveDirection::Right:
-            case MoveDirection::Down:
-                cellsIndexDelta = previousCellIndex - cellIndex;
-                break;
-            case MoveDirection::None:
-                Q_ASSERT(false);
-                break;
-            }
 
-            if (neighborCellsIndexDelta != cellsIndexDelta) {
-                switch (direction) {
-                case MoveDirection::Left:
-                case MoveDirection::Up:
-                    previousCellIndex += neighborCellsIndexDelta;
-                    break;
-                case MoveDirection::Right:
-                case MoveDirection::Down:
-                    previousCellIndex -= neighborCellsIndexDelta;
-                    break;
-                case MoveDirection::None:
-                    Q_ASSERT(false);
-                    break;
-                }
-                previousCell = d->m_cells.at(previousCellIndex);
-                cell->tile()->setZ(0);
-                d->moveTile(cell, previousCell);
-                continue;
-            }
-
-            previousCellIndex = cellIndex;
-        }
+void GameController::onAutoplayToggleRequested()
+{
+    if (d->m_autoplay) {
+        d->stopAutoplay();
+    } else {
+        d->startAutoplay();
     }
+}
 
-    d->m_parentTurnId = d->m_turnId;
-    d->m_turnId = ++d->m_turnIdSequence;
 
-    if (0 == d->m_movingTilesCount)
-      d->m_moveBlocked = false;
+void GameController::onAutoplayFasterRequested()
+{
+    d->setAutoplayRateIndex(d->m_autoplayRateIndex + 1);
 }
 
 
-void GameController::onTileMoveFinished()
+void GameController::onAutoplaySlowerRequested()
 {
-    Q_ASSERT(d->m_movingTilesCount >= 0);
+    d->setAutoplayRateIndex(d->m_autoplayRateIndex - 1);
+}
+
 
-    static bool win = false;
+void GameController::onAutoplayTimeout()
+{
+    d->m_autoplayClock.restart();
 
-    Tile *tile = q_check_ptr(qobject_cast<Tile*>(sender()));
+    const int turnId = d->m_turnId;
+    onMoveTilesRequested(d->m_autoplayMove);
 
-    if (WINNING_VALUE == tile->value() && GameState::Continue != d->m_game->gameState()) {
-        win = true;
+    // The move didn't fit the board, the position changed while it was searched
+    if (turnId == d->m_turnId) {
+        d->requestAutoplayMove();
     }
+}
 
-    if (0 == --d->m_movingTilesCount) {
-        int score = d->m_game->score();
-        for (const auto &tile : d->m_aboutToHiddenTiles) {
-            score += tile->value() * 2;
-            d->hideTile(tile, false);
-        }
 
-        d->m_aboutToHiddenTiles.clear();
-        d->m_game->setScore(score);
+void GameController::onMoveTilesRequested(MoveDirection direction)
+{
+    if (d->m_moveBlocked || MoveDirection::None == direction) {
+        return;
+    }
+
+    if (!d->canMove(direction)) {
+        return;
+    }
 
-        bool moveBlocked = false;
+    d->m_moveBlocked = true;
+    d->m_moveDirection = direction;
 
-        if (win) {
-            d->m_game->setGameState(GameState::Win);
-            moveBlocked = true;
-            win = false;
-        } else {
-            d->createRandomTile();
-        }
+    d->cancelHint();
+    d->setMoveAnimation(!d->m_autoplay || MAX_ANIMATED_AUTOPLAY_RATE >= d->autoplayRate());
+    d->pushUndoTurn();
+    d->moveTiles(direction);
+    Q_ASSERT(0 < d->m_movingTilesCount);
 
-        if (d->isDefeat()) {
-            d->m_game->setGameState(GameState::Defeat);
-            moveBlocked = true;
-        }
+    d->m_parentTurnId = d->m_turnId;
+    d->m_turnId = ++d->m_turnIdSequence;
+    d->seedRandom();
 
-        if (StorageState::Ready == d->m_storage->state()) {
-            d->saveTurn();
-        }
+    // No tile is going to report the end of its move
+    if (!d->m_moveAnimation) {
+        d->m_movingTilesCount = 0;
+        d->finishMove();
+    }
+}
 
-        if (!moveBlocked) {
-            d->m_moveBlocked = false;
-        }
+
+void GameController::onTileMoveFinished()
+{
+    Q_ASSERT(d->m_movingTilesCount > 0);
+
+    if (0 == --d->m_movingTilesCount) {
+        d->finishMove();
     }
 }
 
@@ -794,18 +1132,28 @@ void GameController::onGameRestored(const QVariantMap &game)
     Q_ASSERT_X(game.contains(QLatin1Literal(Internal::SCORE_KEY)), "Restore game", "Score key not found");
     Q_ASSERT_X(game.contains(QLatin1Literal(Internal::BEST_SCORE_KEY)), "Restore game", "Best score key not found");
     Q_ASSERT_X(game.contains(QLatin1Literal(Internal::GAME_STATE_KEY)), "Restore game", "Game state key not found");
+    Q_ASSERT_X(game.contains(QLatin1Literal(Internal::SEED_KEY)), "Restore game", "Seed key not found");
+
+    const int rows = game.value(QLatin1Literal(Internal::ROWS_KEY)).toInt();
+    const int columns = game.value(QLatin1Literal(Internal::COLUMNS_KEY)).toInt();
+    if (!d->isGameboardSizeSupported(rows, columns)) {
+        qWarning() << "Stored gameboard" << rows << "x" << columns << "is not supported, starting a new game";
+        onRestoreGameError();
+        return;
+    }
 
     d->m_gameId = game.value(QLatin1Literal(Internal::GAME_ID_KEY)).toInt();
     d->m_turnId = game.value(QLatin1Literal(Internal::TURN_ID_KEY)).toInt();
     d->m_parentTurnId = game.value(QLatin1Literal(Internal::PARENT_TURN_ID_KEY)).toInt();
     d->m_turnIdSequence = game.value(QLatin1Literal(Internal::MAX_TURN_ID_KEY)).toInt();
+    d->m_seed = std::uint64_t(game.value(QLatin1Literal(Internal::SEED_KEY)).toLongLong());
+    d->seedRandom();
     d->m_restoredTiles = game.value(QLatin1Literal(Internal::TILES_KEY)).toList();
-    d->setGameboardSize(game.value(QLatin1Literal(Internal::ROWS_KEY)).toInt(),
-                        game.value(QLatin1Literal(Internal::COLUMNS_KEY)).toInt());
+    d->setGameboardSize(rows, columns);
     d->m_game->setScore(game.value(QLatin1Literal(Internal::SCORE_KEY)).toInt());
     d->m_game->setBestScore(game.value(QLatin1Literal(Internal::BEST_SCORE_KEY)).toInt());
     d->m_game->setGameState(game.value(QLatin1Literal(Internal::GAME_STATE_KEY)).value<GameState>());
-    d->m_game->setUndoButtonEnabled(!d->isFirstTurn(), false);
+    d->m_game->setUndoButtonEnabled(false, false);
     d->m_game->show();
 
     Q_ASSERT(0 < d->m_game->gameboardRows() && 0 < d->m_game->gameboardColumns());
@@ -825,35 +1173,15 @@ void GameController::onRestoreGameError()
 }
 
 
-void GameController::onTurnSaved()
-{
-    if (d->m_undoEnabled && !d->isFirstTurn() && !d->m_game->isUndoButtonEnabled()) {
-        d->m_game->setUndoButtonEnabled(true);
-    }
-}
-
-
 void GameController::onSaveTurnError()
 {
-    if (d->m_undoEnabled) {
-        d->m_undoEnabled = false;
-        d->m_game->setUndoButtonEnabled(false);
-    }
-}
-
-
-void GameController::onTurnUndid(const QVariantMap &turn)
-{
-    // TODO: realisation
-    d->m_moveBlocked = false;
+    qWarning() << "Failed to save turn" << d->m_turnId;
 }
 
 
 void GameController::onUndoTurnError()
 {
-    d->m_undoEnabled = false;
-    d->m_game->setUndoButtonEnabled(false);
-    d->m_moveBlocked = false;
+    qWarning() << "Failed to undo stored turn, the next move replaces it";
 }
 
 
@@ -866,7 +1194,8 @@ void GameController::startNewGame()
     d->m_turnId = FIRST_TURN_ID;
     d->m_parentTurnId = FIRST_PARENT_TURN_ID;
     d->m_turnIdSequence = FIRST_TURN_ID;
-    d->m_undoEnabled = true;
+    d->m_undoBuffer.clear();
+    d->seedRandom();
     d->clearTiles();
     d->createStartTiles();
 
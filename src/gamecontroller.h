@@ -54,6 +54,13 @@ private slots:
     void onStartNewGameRequested();
     void onContinueGameRequested();
     void onUndoRequested();
+    void onHintRequested();
+    void onHintCancelRequested();
+    void onHintFound(MoveDirection direction);
+    void onAutoplayToggleRequested();
+    void onAutoplayFasterRequested();
+    void onAutoplaySlowerRequested();
+    void onAutoplayTimeout();
     void onMoveTilesRequested(MoveDirection direction);
     void onTileMoveFinished();
     void onStorageReady();
@@ -62,9 +69,7 @@ private slots:
     void onCreateGameError();
     void onGameRestored(const QVariantMap &game);
     void onRestoreGameError();
-    void onTurnSaved();
     void onSaveTurnError();
-    void onTurnUndid(const QVariantMap &turn);
     void onUndoTurnError();
     void startNewGame();
     void restoreGame();
@@ -0,0 +1,145 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "heuristic.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const int ROW_BITS = 16;
+static const std::uint64_t ROW_MASK = 0xFFFF;
+static const int ROWS_COUNT = 0x10000;
+static const int CELL_BITS = 4;
+
+static const float DEFAULT_EMPTY_WEIGHT = 270.0f;
+static const float DEFAULT_MERGES_WEIGHT = 700.0f;
+static const float DEFAULT_MONOTONICITY_WEIGHT = 47.0f;
+static const float DEFAULT_SMOOTHNESS_WEIGHT = 10.0f;
+static const float MONOTONICITY_POWER = 4.0f;
+// Keeps live boards above the zero a lost board gets, spread over the 8 lines
+static const float LINE_BASE_SCORE = 200000.0f / 8;
+
+
+namespace Game {
+namespace Internal {
+
+HeuristicWeights Heuristic::defaultWeights()
+{
+    return { DEFAULT_EMPTY_WEIGHT, DEFAULT_MERGES_WEIGHT, DEFAULT_MONOTONICITY_WEIGHT, DEFAULT_SMOOTHNESS_WEIGHT };
+}
+
+
+Heuristic::Heuristic(const HeuristicWeights &weights) :
+    m_weights(weights),
+    m_rowScores(new float[ROWS_COUNT])
+{
+    setWeights(weights);
+}
+
+
+Heuristic::~Heuristic() = default;
+
+
+const HeuristicWeights &Heuristic::weights() const
+{
+    return m_weights;
+}
+
+
+void Heuristic::setWeights(const HeuristicWeights &weights)
+{
+    m_weights = weights;
+
+    for (int row = 0; row < ROWS_COUNT; ++row) {
+        int exponents[BoardEngine::COLUMNS];
+        for (int column = 0; column < BoardEngine::COLUMNS; ++column) {
+            exponents[column] = (row >> (CELL_BITS * column)) & 0xF;
+        }
+
+        m_rowScores[row] = lineScore(exponents, weights);
+    }
+}
+
+
+float Heuristic::evaluate(Board board) const
+{
+    const Board transposed = BoardEngine::transpose(board);
+
+    return m_rowScores[board & ROW_MASK] +
+           m_rowScores[(board >> ROW_BITS) & ROW_MASK] +
+           m_rowScores[(board >> (2 * ROW_BITS)) & ROW_MASK] +
+           m_rowScores[board >> (3 * ROW_BITS)] +
+           m_rowScores[transposed & ROW_MASK] +
+           m_rowScores[(transposed >> ROW_BITS) & ROW_MASK] +
+           m_rowScores[(transposed >> (2 * ROW_BITS)) & ROW_MASK] +
+           m_rowScores[transposed >> (3 * ROW_BITS)];
+}
+
+
+float Heuristic::lineScore(const int exponents[BoardEngine::COLUMNS], const HeuristicWeights &weights)
+{
+    int empty = 0;
+    int merges = 0;
+    int roughness = 0;
+    int previous = 0;
+
+    // Empty cells don't stop tiles from meeting, so merges and smoothness skip them
+    for (int column = 0; column < BoardEngine::COLUMNS; ++column) {
+        const int exponent = exponents[column];
+
+        if (0 == exponent) {
+            ++empty;
+            continue;
+        }
+
+        if (0 != previous) {
+            if (previous == exponent) {
+                ++merges;
+                previous = 0;
+                continue;
+            }
+            roughness += std::abs(previous - exponent);
+        }
+
+        previous = exponent;
+    }
+
+    float increasing = 0.0f;
+    float decreasing = 0.0f;
+
+    for (int column = 1; column < BoardEngine::COLUMNS; ++column) {
+        const float left = std::pow(float(exponents[column - 1]), MONOTONICITY_POWER);
+        const float right = std::pow(float(exponents[column]), MONOTONICITY_POWER);
+
+        if (left > right) {
+            decreasing += left - right;
+        } else {
+            increasing += right - left;
+        }
+    }
+
+    return LINE_BASE_SCORE + weights.empty * empty + weights.merges * merges -
+           weights.monotonicity * std::min(increasing, decreasing) - weights.smoothness * roughness;
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,77 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef HEURISTIC_H
+#define HEURISTIC_H
+
+#include <cstdint>
+#include <memory>
+
+#include "boardengine.h"
+
+
+namespace Game {
+namespace Internal {
+
+struct HeuristicWeights
+{
+    // Per empty cell
+    float empty;
+    // Per pair of equal tiles which would meet on a move along the line
+    float merges;
+    // Penalty for the fourth powers of the exponents going against the line's main direction
+    float monotonicity;
+    // Penalty per exponent step between neighbouring tiles
+    float smoothness;
+};
+
+// Board evaluation from a table of row scores. Every feature only depends on one line,
+// so a board costs 4 lookups for its rows and 4 for the rows of its transpose.
+// Changing the weights rebuilds the table.
+class Heuristic final
+{
+public:
+    static HeuristicWeights defaultWeights();
+
+    explicit Heuristic(const HeuristicWeights &weights = defaultWeights());
+    ~Heuristic();
+
+    const HeuristicWeights &weights() const;
+    void setWeights(const HeuristicWeights &weights);
+
+    float evaluate(Board board) const;
+
+    // The score of one line from the features, without the table
+    static float lineScore(const int exponents[BoardEngine::COLUMNS], const HeuristicWeights &weights);
+
+private:
+    Heuristic(const Heuristic &) = delete;
+    Heuristic &operator=(const Heuristic &) = delete;
+
+    HeuristicWeights m_weights;
+    std::unique_ptr<float[]> m_rowScores;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // HEURISTIC_H
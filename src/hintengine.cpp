@@ -0,0 +1,149 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "boardengine.h"
+#include "hintengine.h"
+#include "hintworker.h"
+
+#include <QDebug>
+#include <QThread>
+
+#include <atomic>
+
+static const int WORKER_THREAD_QUIT_TIMEOUT = 3000;
+
+
+namespace Game {
+namespace Internal {
+
+static MoveDirection toMoveDirection(Direction direction)
+{
+    switch (direction) {
+    case Direction::Left:
+        return MoveDirection::Left;
+    case Direction::Right:
+        return MoveDirection::Right;
+    case Direction::Up:
+        return MoveDirection::Up;
+    case Direction::Down:
+        return MoveDirection::Down;
+    }
+
+    Q_ASSERT(false);
+    return MoveDirection::None;
+}
+
+
+class HintEnginePrivate final
+{
+public:
+    explicit HintEnginePrivate(HintEngine *parent);
+    ~HintEnginePrivate();
+
+    HintEngine *const q;
+
+    std::atomic<int> m_requestId;
+    const std::unique_ptr<QThread> m_workerThread;
+    const std::unique_ptr<HintWorker> m_worker;
+    bool m_searching;
+};
+
+
+HintEnginePrivate::HintEnginePrivate(HintEngine *parent) :
+    q(parent),
+    m_requestId(0),
+    m_workerThread(std::make_unique<QThread>(parent)),
+    m_worker(std::make_unique<HintWorker>(m_requestId)),
+    m_searching(false)
+{
+    m_worker->moveToThread(m_workerThread.get());
+
+    QObject::connect(m_worker.get(), &HintWorker::hintFound, q, &HintEngine::onHintFound);
+
+    m_workerThread->start();
+}
+
+
+HintEnginePrivate::~HintEnginePrivate()
+{
+    ++m_requestId;
+    m_worker->stop();
+    m_workerThread->quit();
+    if (!m_workerThread->wait(WORKER_THREAD_QUIT_TIMEOUT)) {
+        qWarning() << "Failed to quit from hint worker thread";
+        m_workerThread->terminate();
+    }
+}
+
+
+HintEngine::HintEngine(QObject *parent) :
+    QObject(parent),
+    d(std::make_unique<HintEnginePrivate>(this))
+{
+}
+
+
+HintEngine::~HintEngine()
+{
+}
+
+
+bool HintEngine::isSearching() const
+{
+    return d->m_searching;
+}
+
+
+void HintEngine::requestHint(quint64 board, int rows, int columns, int timeBudget)
+{
+    cancel();
+
+    d->m_searching = true;
+    QMetaObject::invokeMethod(d->m_worker.get(), "search", Qt::QueuedConnection,
+                              Q_ARG(quint64, board), Q_ARG(int, rows), Q_ARG(int, columns),
+                              Q_ARG(int, d->m_requestId.load()), Q_ARG(int, timeBudget));
+}
+
+
+void HintEngine::cancel()
+{
+    // The worker drops any request but the latest one, and the running search stops at its next node
+    ++d->m_requestId;
+    d->m_worker->stop();
+    d->m_searching = false;
+}
+
+
+void HintEngine::onHintFound(int requestId, int direction)
+{
+    // A result may still be queued when its request was superseded
+    if (requestId != d->m_requestId.load()) {
+        return;
+    }
+
+    // A negative direction is a position the worker has no move for
+    d->m_searching = false;
+    emit hintFound(direction < 0 ? MoveDirection::None : toMoveDirection(Direction(direction)));
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,69 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef HINTENGINE_H
+#define HINTENGINE_H
+
+#include <memory>
+
+#include <QObject>
+
+#include "movedirection.h"
+
+
+namespace Game {
+namespace Internal {
+
+class HintEnginePrivate;
+
+// Searches positions on a worker thread, a new request or a cancel drops the running one
+class HintEngine final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HintEngine(QObject *parent = nullptr);
+    ~HintEngine();
+
+    bool isSearching() const;
+
+signals:
+    void hintFound(MoveDirection direction);
+
+public slots:
+    void requestHint(quint64 board, int rows, int columns, int timeBudget);
+    void cancel();
+
+private slots:
+    void onHintFound(int requestId, int direction);
+
+private:
+    Q_DISABLE_COPY(HintEngine)
+
+    const std::unique_ptr<HintEnginePrivate> d;
+
+    friend class HintEnginePrivate;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // HINTENGINE_H
@@ -0,0 +1,150 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "hintworker.h"
+#include "tablebase.h"
+#include "threadpool.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+
+#include <chrono>
+#include <utility>
+
+static const int MAX_HINT_DEPTH = 8;
+static const std::size_t TRANSPOSITION_TABLE_ENTRIES = 1 << 20;
+static const int NO_HINT = -1;
+
+static const char *const TABLEBASE_FILE_NAME = "2048-%1x%2.tablebase";
+#ifdef Q_OS_MACOS
+static const char *const TABLEBASE_FILE_LOCATION = "%1/../Resources/tablebases/%2";
+#else
+static const char *const TABLEBASE_FILE_LOCATION = "%1/tablebases/%2";
+#endif
+
+
+namespace Game {
+namespace Internal {
+
+struct HintWorker::TablebaseFile
+{
+    QFile file;
+    Tablebase tablebase;
+};
+
+
+HintWorker::HintWorker(const std::atomic<int> &latestRequestId) :
+    m_latestRequestId(latestRequestId),
+    m_stop(false),
+    m_pool(std::make_unique<ThreadPool>()),
+    m_table(TRANSPOSITION_TABLE_ENTRIES, ReplacementPolicy::Generation),
+    m_search(m_pool.get()),
+    m_deepening(m_search)
+{
+    m_search.setStopFlag(&m_stop);
+    m_search.setTranspositionTable(&m_table);
+    m_search.setHeuristic(&m_heuristic);
+    m_deepening.setMaxDepth(MAX_HINT_DEPTH);
+}
+
+
+HintWorker::~HintWorker()
+{
+}
+
+
+void HintWorker::stop()
+{
+    m_stop.store(true);
+}
+
+
+void HintWorker::search(quint64 board, int rows, int columns, int requestId, int timeBudget)
+{
+    // Cleared before the check, so a request cancelled after the check still stops the search
+    m_stop.store(false);
+
+    if (requestId != m_latestRequestId.load()) {
+        return;
+    }
+
+    if (BoardEngine::ROWS != rows || BoardEngine::COLUMNS != columns) {
+        const Tablebase *tablebase = this->tablebase(rows, columns);
+        TablebaseEntry entry;
+
+        if (tablebase && tablebase->lookup(board, entry)) {
+            emit hintFound(requestId, int(entry.bestMove));
+        } else {
+            emit hintFound(requestId, NO_HINT);
+        }
+
+        return;
+    }
+
+    // Every request is answered, so the engine doesn't keep waiting for a lost board
+    if (0 == BoardEngine::legalMoves(board)) {
+        emit hintFound(requestId, NO_HINT);
+        return;
+    }
+
+    const DeepeningResult result = m_deepening.search(board, std::chrono::milliseconds(timeBudget));
+
+    if (requestId == m_latestRequestId.load()) {
+        emit hintFound(requestId, int(result.bestMove));
+    }
+}
+
+
+const Tablebase *HintWorker::tablebase(int rows, int columns)
+{
+    const int key = rows * BoardEngine::COLUMNS + columns;
+    const auto it = m_tablebases.find(key);
+    if (m_tablebases.cend() != it) {
+        return it->second ? &it->second->tablebase : nullptr;
+    }
+
+    const QString &fileName = QString(QLatin1Literal(TABLEBASE_FILE_LOCATION))
+            .arg(QCoreApplication::applicationDirPath(), QString(QLatin1Literal(TABLEBASE_FILE_NAME)).arg(rows).arg(columns));
+
+    auto tablebaseFile = std::make_unique<TablebaseFile>();
+    tablebaseFile->file.setFileName(fileName);
+
+    // The mapping is only paged in where the lookups read it
+    const uchar *data = nullptr;
+    if (tablebaseFile->file.open(QIODevice::ReadOnly)) {
+        data = tablebaseFile->file.map(0, tablebaseFile->file.size());
+    }
+
+    if (!data || !tablebaseFile->tablebase.attach(data, std::size_t(tablebaseFile->file.size())) ||
+            rows != tablebaseFile->tablebase.rows() || columns != tablebaseFile->tablebase.columns()) {
+        qWarning() << "No tablebase for" << rows << "x" << columns << "board in" << fileName;
+        tablebaseFile.reset();
+    }
+
+    const Tablebase *tablebase = tablebaseFile ? &tablebaseFile->tablebase : nullptr;
+    m_tablebases.emplace(key, std::move(tablebaseFile));
+    return tablebase;
+}
+
+} // namespace Internal
+} // namespace Game
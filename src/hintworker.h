@@ -0,0 +1,83 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef HINTWORKER_H
+#define HINTWORKER_H
+
+#include <QObject>
+
+#include <atomic>
+#include <map>
+#include <memory>
+
+#include "expectimax.h"
+#include "heuristic.h"
+#include "iterativedeepening.h"
+#include "transpositiontable.h"
+
+
+namespace Game {
+namespace Internal {
+
+class Tablebase;
+class ThreadPool;
+
+class HintWorker final : public QObject
+{
+    Q_OBJECT
+public:
+    // Requests whose id isn't the latest one are dropped
+    explicit HintWorker(const std::atomic<int> &latestRequestId);
+    ~HintWorker();
+
+    // Safe to call from any thread, stops the running search
+    void stop();
+
+signals:
+    void hintFound(int requestId, int direction);
+
+public slots:
+    // 4x4 boards are searched, smaller ones looked up in the tablebase of their size
+    void search(quint64 board, int rows, int columns, int requestId, int timeBudget);
+
+private:
+    Q_DISABLE_COPY(HintWorker)
+
+    struct TablebaseFile;
+
+    const Tablebase *tablebase(int rows, int columns);
+
+    const std::atomic<int> &m_latestRequestId;
+    std::atomic<bool> m_stop;
+    const std::unique_ptr<ThreadPool> m_pool;
+    TranspositionTable m_table;
+    Heuristic m_heuristic;
+    Expectimax m_search;
+    IterativeDeepening m_deepening;
+    // Mapped on the first lookup of a board size, a null file is a missing one
+    std::map<int, std::unique_ptr<TablebaseFile>> m_tablebases;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // HINTWORKER_H
@@ -0,0 +1,121 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "iterativedeepening.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+
+namespace Game {
+namespace Internal {
+
+using Clock = Expectimax::Clock;
+
+
+IterativeDeepening::IterativeDeepening(Expectimax &search) :
+    m_search(search),
+    m_maxDepth(DEFAULT_MAX_DEPTH)
+{
+}
+
+
+int IterativeDeepening::maxDepth() const
+{
+    return m_maxDepth;
+}
+
+
+void IterativeDeepening::setMaxDepth(int depth)
+{
+    assert(0 < depth);
+    m_maxDepth = depth;
+}
+
+
+DeepeningResult IterativeDeepening::search(Board board, std::chrono::microseconds budget)
+{
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline = start + budget;
+    const int depth = m_search.depth();
+    const Clock::time_point searchDeadline = m_search.deadline();
+
+    DeepeningResult result;
+    result.legalMoves = BoardEngine::legalMoves(board);
+    result.bestMove = Direction::Left;
+    result.values.fill(std::numeric_limits<double>::lowest());
+    result.depth = 0;
+    result.nodes = 0;
+
+    Expectimax::MoveOrder order = {{ Direction::Left, Direction::Right, Direction::Up, Direction::Down }};
+    Clock::duration previousIteration = Clock::duration::zero();
+    Clock::duration lastIteration = Clock::duration::zero();
+
+    for (int iteration = 1; iteration <= m_maxDepth && 0 != result.legalMoves; ++iteration) {
+        const Clock::time_point iterationStart = Clock::now();
+
+        if (1 < iteration && deadline <= iterationStart) {
+            break;
+        }
+
+        // The next iteration is expected to grow as much as the last one did
+        if (Clock::duration::zero() < previousIteration) {
+            const double growth = std::max(1.0, double(lastIteration.count()) / previousIteration.count());
+            const auto expected = std::chrono::duration_cast<Clock::duration>(lastIteration * growth);
+            if (deadline < iterationStart + expected) {
+                break;
+            }
+        }
+
+        m_search.setDepth(iteration);
+        m_search.setDeadline(1 == iteration ? Clock::time_point::max() : deadline);
+
+        const SearchResult searched = m_search.search(board, order);
+        result.nodes += searched.nodes;
+
+        if (!searched.complete) {
+            break;
+        }
+
+        result.bestMove = searched.bestMove;
+        result.values = searched.values;
+        result.depth = iteration;
+
+        std::stable_sort(order.begin(), order.end(), [&searched](Direction a, Direction b) {
+            return searched.values[std::size_t(a)] > searched.values[std::size_t(b)];
+        });
+
+        previousIteration = lastIteration;
+        lastIteration = Clock::now() - iterationStart;
+    }
+
+    m_search.setDepth(depth);
+    m_search.setDeadline(searchDeadline);
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    return result;
+}
+
+} // namespace Internal
+} // namespace Game
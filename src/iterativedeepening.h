@@ -0,0 +1,72 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef ITERATIVEDEEPENING_H
+#define ITERATIVEDEEPENING_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "expectimax.h"
+
+
+namespace Game {
+namespace Internal {
+
+struct DeepeningResult
+{
+    Directions legalMoves;
+    Direction bestMove;
+    // Values of the last completed depth
+    std::array<double, 4> values;
+    int depth;
+    // Including the iteration which ran out of time
+    std::uint64_t nodes;
+    double seconds;
+};
+
+// Searches depth 1, 2, ... until the time budget runs out and returns the move of the last completed depth.
+// Every iteration queues the root moves best first by the values of the one before.
+// Depth 1 always completes, an iteration which isn't expected to fit in the rest of the budget isn't started.
+// A zero budget searches depth 1 only.
+class IterativeDeepening final
+{
+public:
+    static const int DEFAULT_MAX_DEPTH = 12;
+
+    explicit IterativeDeepening(Expectimax &search);
+
+    int maxDepth() const;
+    void setMaxDepth(int depth);
+
+    DeepeningResult search(Board board, std::chrono::microseconds budget);
+
+private:
+    Expectimax &m_search;
+    int m_maxDepth;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // ITERATIVEDEEPENING_H
@@ -0,0 +1,170 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "legacymove.h"
+
+#include <cassert>
+#include <utility>
+
+
+namespace Game {
+namespace Internal {
+
+// Every line is walked from the wall, previousCellIndex is the cell the next tile slides or merges to.
+// Vertical lines swap rows and columns, so a row of the walk is a column of the board.
+KernelResult LegacyMove::move(std::uint8_t *cells, int rows, int columns, Direction direction)
+{
+    assert(0 < rows && 0 < columns);
+
+    KernelResult result = { 0, 0, 0 };
+
+    switch (direction) {
+    case Direction::Left:
+    case Direction::Right:
+        break;
+    case Direction::Up:
+    case Direction::Down:
+        std::swap(rows, columns);
+        break;
+    }
+
+    for (int row = 0; row < rows; ++row) {
+        int firstCellIndex = 0;
+        int neighborCellsIndexDelta = 0;
+
+        // The walk used to count Down cells from columns * (rows - 1), which is the bottom row
+        // only on square boards and runs past the last cell of boards wider than tall
+        switch (direction) {
+        case Direction::Left:
+            firstCellIndex = row * columns;
+            neighborCellsIndexDelta = 1;
+            break;
+        case Direction::Right:
+            firstCellIndex = row * columns + columns - 1;
+            neighborCellsIndexDelta = 1;
+            break;
+        case Direction::Up:
+            firstCellIndex = row;
+            neighborCellsIndexDelta = rows;
+            break;
+        case Direction::Down:
+            firstCellIndex = rows * (columns - 1) + row;
+            neighborCellsIndexDelta = rows;
+            break;
+        }
+
+        int previousCellIndex = firstCellIndex;
+
+        for (int column = 1; column < columns; ++column) {
+            int cellIndex = 0;
+
+            switch (direction) {
+            case Direction::Left:
+                cellIndex = firstCellIndex + column;
+                break;
+            case Direction::Right:
+                cellIndex = firstCellIndex - column;
+                break;
+            case Direction::Up:
+                cellIndex = column * rows + row;
+                break;
+            case Direction::Down:
+                cellIndex = firstCellIndex - column * rows;
+                break;
+            }
+
+            const int exponent = cells[cellIndex];
+
+            if (0 == exponent) {
+                continue;
+            }
+
+            if (0 == cells[previousCellIndex]) {
+                cells[previousCellIndex] = std::uint8_t(exponent);
+                cells[cellIndex] = 0;
+                ++result.moves;
+                continue;
+            }
+
+            if (cells[previousCellIndex] == exponent) {
+                cells[previousCellIndex] = std::uint8_t(exponent + 1);
+                cells[cellIndex] = 0;
+                result.score += 1 << (exponent + 1);
+                ++result.merges;
+                ++result.moves;
+
+                switch (direction) {
+                case Direction::Left:
+                    ++previousCellIndex;
+                    break;
+                case Direction::Right:
+                    --previousCellIndex;
+                    break;
+                case Direction::Up:
+                    previousCellIndex += rows;
+                    break;
+                case Direction::Down:
+                    previousCellIndex -= rows;
+                    break;
+                }
+                continue;
+            }
+
+            int cellsIndexDelta = 0;
+
+            switch (direction) {
+            case Direction::Left:
+            case Direction::Up:
+                cellsIndexDelta = cellIndex - previousCellIndex;
+                break;
+            case Direction::Right:
+            case Direction::Down:
+                cellsIndexDelta = previousCellIndex - cellIndex;
+                break;
+            }
+
+            if (neighborCellsIndexDelta != cellsIndexDelta) {
+                switch (direction) {
+                case Direction::Left:
+                case Direction::Up:
+                    previousCellIndex += neighborCellsIndexDelta;
+                    break;
+                case Direction::Right:
+                case Direction::Down:
+                    previousCellIndex -= neighborCellsIndexDelta;
+                    break;
+                }
+                cells[previousCellIndex] = std::uint8_t(exponent);
+                cells[cellIndex] = 0;
+                ++result.moves;
+                continue;
+            }
+
+            previousCellIndex = cellIndex;
+        }
+    }
+
+    return result;
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,50 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef LEGACYMOVE_H
+#define LEGACYMOVE_H
+
+#include <cstdint>
+
+#include "boardengine.h"
+#include "movekernel.h"
+
+
+namespace Game {
+namespace Internal {
+
+// The cell walk the game controller moved tiles with before the board engines,
+// kept as the reference of the move rules the engines are fuzzed against.
+class LegacyMove final
+{
+public:
+    // Moves the row-major tile exponents of a rows x columns board in place
+    static KernelResult move(std::uint8_t *cells, int rows, int columns, Direction direction);
+
+private:
+    LegacyMove() = delete;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // LEGACYMOVE_H
@@ -0,0 +1,339 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "mctsplayer.h"
+#include "arena.h"
+#include "montecarloplayer.h"
+#include "randomgenerator.h"
+#include "threadpool.h"
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+static const double DEFAULT_EXPLORATION = 0.5;
+
+
+namespace Game {
+namespace Internal {
+
+namespace {
+
+struct ChanceNode;
+
+struct NodeStatistics
+{
+    std::atomic<std::uint32_t> visits;
+    std::atomic<std::int64_t> score;
+
+    NodeStatistics() : visits(0), score(0) {}
+
+    double mean() const
+    {
+        const std::uint32_t count = visits.load(std::memory_order_relaxed);
+        return 0 == count ? 0.0 : double(score.load(std::memory_order_relaxed)) / count;
+    }
+};
+
+struct MoveNode : NodeStatistics
+{
+    const Board board;
+    std::atomic<ChanceNode*> children[4];
+    // The next child of the same chance node
+    std::atomic<MoveNode*> sibling;
+
+    explicit MoveNode(Board board) : board(board), sibling(nullptr)
+    {
+        for (auto &child : children) {
+            child.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+};
+
+// The board after a move, before the spawn
+struct ChanceNode : NodeStatistics
+{
+    const Board board;
+    const int moveScore;
+    std::atomic<MoveNode*> children;
+
+    ChanceNode(Board board, int moveScore) : board(board), moveScore(moveScore), children(nullptr) {}
+};
+
+struct PathNode
+{
+    NodeStatistics *node;
+    int moveScore;
+};
+
+} // namespace
+
+
+static double rollout(Board board, RandomGenerator &random)
+{
+    std::uint64_t moves = 0;
+    return double(MonteCarloPlayer::rollout(board, random, moves));
+}
+
+
+// Unvisited moves go first, then the best upper confidence bound scaled to the scores of the node
+static int selectMove(const MoveNode &node, Directions legalMoves, double exploration)
+{
+    const std::uint32_t visits = node.visits.load(std::memory_order_relaxed);
+    const double logVisits = std::log(double(visits));
+    const double scale = std::max(1.0, node.mean());
+
+    int bestMove = -1;
+    double bestValue = std::numeric_limits<double>::lowest();
+
+    for (int move = 0; move < 4; ++move) {
+        if (0 == (legalMoves & BoardEngine::directionBit(Direction(move)))) {
+            continue;
+        }
+
+        const ChanceNode *child = node.children[move].load(std::memory_order_acquire);
+        const std::uint32_t childVisits = child ? child->visits.load(std::memory_order_relaxed) : 0;
+        if (0 == childVisits) {
+            return move;
+        }
+
+        const double value = child->mean() + exploration * scale * std::sqrt(logVisits / childVisits);
+        if (bestValue < value) {
+            bestValue = value;
+            bestMove = move;
+        }
+    }
+
+    return bestMove;
+}
+
+
+static ChanceNode *chanceChild(MoveNode &node, int move, Arena &arena)
+{
+    ChanceNode *child = node.children[move].load(std::memory_order_acquire);
+    if (child) {
+        return child;
+    }
+
+    const MoveResult moved = BoardEngine::move(node.board, Direction(move));
+    ChanceNode *created = arena.create<ChanceNode>(moved.board, moved.score);
+    if (!created) {
+        return nullptr;
+    }
+
+    // Another thread may have got there first, its node wins and ours is left in the arena
+    if (node.children[move].compare_exchange_strong(child, created, std::memory_order_acq_rel)) {
+        return created;
+    }
+
+    return child;
+}
+
+
+static MoveNode *moveChild(ChanceNode &node, Board board, Arena &arena)
+{
+    MoveNode *head = node.children.load(std::memory_order_acquire);
+    MoveNode *created = nullptr;
+
+    for (;;) {
+        for (MoveNode *child = head; child; child = child->sibling.load(std::memory_order_relaxed)) {
+            if (board == child->board) {
+                return child;
+            }
+        }
+
+        if (!created) {
+            created = arena.create<MoveNode>(board);
+            if (!created) {
+                return nullptr;
+            }
+        }
+
+        // Pushed in front of the children seen, the scan is repeated over new ones when that fails
+        created->sibling.store(head, std::memory_order_relaxed);
+        if (node.children.compare_exchange_weak(head, created, std::memory_order_acq_rel)) {
+            return created;
+        }
+    }
+}
+
+
+static void runIteration(MoveNode &root, Arena &arena, RandomGenerator &random, double exploration,
+                         std::vector<PathNode> &path)
+{
+    path.clear();
+
+    MoveNode *node = &root;
+    double score = 0.0;
+
+    for (;;) {
+        const std::uint32_t visits = node->visits.fetch_add(1, std::memory_order_relaxed);
+        path.push_back({ node, 0 });
+
+        const Directions legalMoves = BoardEngine::legalMoves(node->board);
+        if (0 == legalMoves) {
+            break;
+        }
+
+        if (0 == visits) {
+            score = rollout(node->board, random);
+            break;
+        }
+
+        const int move = selectMove(*node, legalMoves, exploration);
+        ChanceNode *chance = chanceChild(*node, move, arena);
+
+        if (!chance) {
+            const MoveResult moved = BoardEngine::move(node->board, Direction(move));
+            score = moved.score + rollout(BoardEngine::spawnRandomTile(moved.board, random), random);
+            break;
+        }
+
+        chance->visits.fetch_add(1, std::memory_order_relaxed);
+        path.push_back({ chance, chance->moveScore });
+
+        const Board spawned = BoardEngine::spawnRandomTile(chance->board, random);
+        node = moveChild(*chance, spawned, arena);
+
+        if (!node) {
+            score = rollout(spawned, random);
+            break;
+        }
+    }
+
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        score += it->moveScore;
+        it->node->score.fetch_add(std::int64_t(score), std::memory_order_relaxed);
+    }
+}
+
+
+MctsPlayer::MctsPlayer(ThreadPool *pool, std::uint64_t seed, std::size_t arenaSize) :
+    m_pool(pool),
+    m_arena(std::make_unique<Arena>(arenaSize)),
+    m_seed(seed),
+    m_searches(0),
+    m_exploration(DEFAULT_EXPLORATION),
+    m_iterations(DEFAULT_ITERATIONS)
+{
+}
+
+
+MctsPlayer::~MctsPlayer()
+{
+}
+
+
+int MctsPlayer::iterations() const
+{
+    return m_iterations;
+}
+
+
+void MctsPlayer::setIterations(int iterations)
+{
+    assert(0 < iterations);
+    m_iterations = iterations;
+}
+
+
+double MctsPlayer::exploration() const
+{
+    return m_exploration;
+}
+
+
+void MctsPlayer::setExploration(double exploration)
+{
+    assert(0.0 <= exploration);
+    m_exploration = exploration;
+}
+
+
+MctsResult MctsPlayer::search(Board board)
+{
+    MctsResult result;
+    result.legalMoves = BoardEngine::legalMoves(board);
+    result.bestMove = Direction::Left;
+    result.visits.fill(0);
+    result.meanScores.fill(std::numeric_limits<double>::lowest());
+    result.iterations = 0;
+    result.arenaUsed = 0;
+
+    if (0 == result.legalMoves) {
+        return result;
+    }
+
+    m_arena->reset();
+    MoveNode *root = m_arena->create<MoveNode>(board);
+    assert(root);
+
+    const std::uint64_t search = m_searches++;
+    const int tasks = (m_iterations + ITERATIONS_PER_TASK - 1) / ITERATIONS_PER_TASK;
+
+    const auto runTask = [&](int index) {
+        RandomGenerator random(m_seed, (search << 32) | std::uint64_t(index));
+        std::vector<PathNode> path;
+
+        const int first = index * ITERATIONS_PER_TASK;
+        const int last = std::min(first + ITERATIONS_PER_TASK, m_iterations);
+
+        for (int iteration = first; iteration < last; ++iteration) {
+            runIteration(*root, *m_arena, random, m_exploration, path);
+        }
+    };
+
+    if (m_pool) {
+        m_pool->parallelFor(tasks, runTask);
+    } else {
+        for (int index = 0; index < tasks; ++index) {
+            runTask(index);
+        }
+    }
+
+    std::uint32_t bestVisits = 0;
+
+    for (int move = 0; move < 4; ++move) {
+        const ChanceNode *child = root->children[move].load(std::memory_order_acquire);
+        if (!child) {
+            continue;
+        }
+
+        const std::size_t index = std::size_t(move);
+        result.visits[index] = child->visits.load(std::memory_order_relaxed);
+        result.meanScores[index] = child->mean();
+
+        if (bestVisits < result.visits[index]) {
+            bestVisits = result.visits[index];
+            result.bestMove = Direction(move);
+        }
+    }
+
+    result.iterations = std::uint64_t(m_iterations);
+    result.arenaUsed = m_arena->used();
+
+    return result;
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,89 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef MCTSPLAYER_H
+#define MCTSPLAYER_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include "boardengine.h"
+
+
+namespace Game {
+namespace Internal {
+
+class Arena;
+class ThreadPool;
+
+struct MctsResult
+{
+    Directions legalMoves;
+    Direction bestMove;
+    // Root visits of every move, the most visited one is played
+    std::array<std::uint32_t, 4> visits;
+    // Score of the move plus the mean score after it
+    std::array<double, 4> meanScores;
+    std::uint64_t iterations;
+    std::size_t arenaUsed;
+};
+
+// Monte Carlo tree search over move nodes and spawn chance nodes. Chance nodes sample a spawn
+// and keep a child per spawn seen so far. All threads grow one tree: the statistics are atomics
+// and a visit counts before its score arrives, the virtual loss keeps the threads on different paths.
+// The nodes come from an arena which every search resets, so a result outlives the tree.
+class MctsPlayer final
+{
+public:
+    static const int DEFAULT_ITERATIONS = 2000;
+    static const int ITERATIONS_PER_TASK = 32;
+    static const std::size_t DEFAULT_ARENA_SIZE = std::size_t(32) << 20;
+
+    explicit MctsPlayer(ThreadPool *pool = nullptr, std::uint64_t seed = 0,
+                        std::size_t arenaSize = DEFAULT_ARENA_SIZE);
+    ~MctsPlayer();
+
+    int iterations() const;
+    void setIterations(int iterations);
+
+    double exploration() const;
+    void setExploration(double exploration);
+
+    MctsResult search(Board board);
+
+private:
+    MctsPlayer(const MctsPlayer &) = delete;
+    MctsPlayer &operator=(const MctsPlayer &) = delete;
+
+    ThreadPool *const m_pool;
+    const std::unique_ptr<Arena> m_arena;
+    const std::uint64_t m_seed;
+    std::uint64_t m_searches;
+    double m_exploration;
+    int m_iterations;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // MCTSPLAYER_H
@@ -0,0 +1,175 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "montecarloplayer.h"
+#include "bitoperations.h"
+#include "randomgenerator.h"
+#include "threadpool.h"
+
+#include <cassert>
+#include <limits>
+#include <vector>
+
+
+namespace Game {
+namespace Internal {
+
+namespace {
+
+struct RolloutTask
+{
+    Board board;
+    int move;
+    int rollouts;
+    std::uint64_t score;
+    std::uint64_t moves;
+};
+
+} // namespace
+
+
+MonteCarloPlayer::MonteCarloPlayer(ThreadPool *pool, std::uint64_t seed) :
+    m_pool(pool),
+    m_seed(seed),
+    m_searches(0),
+    m_rollouts(DEFAULT_ROLLOUTS)
+{
+}
+
+
+int MonteCarloPlayer::rollouts() const
+{
+    return m_rollouts;
+}
+
+
+void MonteCarloPlayer::setRollouts(int rollouts)
+{
+    assert(0 < rollouts);
+    m_rollouts = rollouts;
+}
+
+
+RolloutResult MonteCarloPlayer::search(Board board)
+{
+    RolloutResult result;
+    result.legalMoves = BoardEngine::legalMoves(board);
+    result.bestMove = Direction::Left;
+    result.meanScores.fill(std::numeric_limits<double>::lowest());
+    result.rollouts = 0;
+    result.moves = 0;
+
+    std::array<std::uint32_t, 4> moveScores = {{ 0, 0, 0, 0 }};
+    std::vector<RolloutTask> tasks;
+
+    for (int move = 0; move < 4; ++move) {
+        if (0 == (result.legalMoves & BoardEngine::directionBit(Direction(move)))) {
+            continue;
+        }
+
+        const MoveResult moved = BoardEngine::move(board, Direction(move));
+        moveScores[std::size_t(move)] = std::uint32_t(moved.score);
+
+        for (int rollouts = 0; rollouts < m_rollouts; rollouts += ROLLOUTS_PER_TASK) {
+            const int taskRollouts = (m_rollouts - rollouts < ROLLOUTS_PER_TASK) ? m_rollouts - rollouts : ROLLOUTS_PER_TASK;
+            tasks.push_back({ moved.board, move, taskRollouts, 0, 0 });
+        }
+    }
+
+    if (0 == result.legalMoves) {
+        return result;
+    }
+
+    const std::uint64_t search = m_searches++;
+
+    const auto runTask = [&](int index) {
+        RolloutTask &task = tasks[std::size_t(index)];
+        RandomGenerator random(m_seed, (search << 32) | std::uint64_t(index));
+
+        // Neighbouring tasks share cache lines, so the totals are written to the task once
+        std::uint64_t score = 0;
+        std::uint64_t moves = 0;
+
+        for (int i = 0; i < task.rollouts; ++i) {
+            score += rollout(BoardEngine::spawnRandomTile(task.board, random), random, moves);
+        }
+
+        task.score = score;
+        task.moves = moves;
+    };
+
+    if (m_pool) {
+        m_pool->parallelFor(int(tasks.size()), runTask);
+    } else {
+        for (int index = 0; index < int(tasks.size()); ++index) {
+            runTask(index);
+        }
+    }
+
+    std::array<std::uint64_t, 4> scores = {{ 0, 0, 0, 0 }};
+    std::array<std::uint64_t, 4> rollouts = {{ 0, 0, 0, 0 }};
+
+    for (const RolloutTask &task : tasks) {
+        scores[std::size_t(task.move)] += task.score;
+        rollouts[std::size_t(task.move)] += std::uint64_t(task.rollouts);
+        result.rollouts += std::uint64_t(task.rollouts);
+        result.moves += task.moves;
+    }
+
+    double bestScore = std::numeric_limits<double>::lowest();
+
+    for (std::size_t move = 0; move < 4; ++move) {
+        if (0 == rollouts[move]) {
+            continue;
+        }
+
+        result.meanScores[move] = moveScores[move] + double(scores[move]) / rollouts[move];
+
+        if (bestScore < result.meanScores[move]) {
+            bestScore = result.meanScores[move];
+            result.bestMove = Direction(move);
+        }
+    }
+
+    return result;
+}
+
+
+std::uint64_t MonteCarloPlayer::rollout(Board board, RandomGenerator &random, std::uint64_t &moves)
+{
+    std::uint64_t score = 0;
+
+    for (Directions legalMoves = BoardEngine::legalMoves(board); 0 != legalMoves;
+         legalMoves = BoardEngine::legalMoves(board)) {
+        const int rank = int(random.bounded(std::uint32_t(popCount(legalMoves))));
+        const MoveResult moved = BoardEngine::move(board, Direction(selectBit(legalMoves, rank)));
+
+        score += std::uint64_t(moved.score);
+        ++moves;
+        board = BoardEngine::spawnRandomTile(moved.board, random);
+    }
+
+    return score;
+}
+
+} // namespace Internal
+} // namespace Game
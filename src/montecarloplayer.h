@@ -0,0 +1,77 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef MONTECARLOPLAYER_H
+#define MONTECARLOPLAYER_H
+
+#include <array>
+#include <cstdint>
+
+#include "boardengine.h"
+
+
+namespace Game {
+namespace Internal {
+
+class RandomGenerator;
+class ThreadPool;
+
+struct RolloutResult
+{
+    Directions legalMoves;
+    Direction bestMove;
+    // Score of the move plus the mean score of its random playouts
+    std::array<double, 4> meanScores;
+    std::uint64_t rollouts;
+    std::uint64_t moves;
+};
+
+// Plays random games to the end after every legal move and picks the move with the best mean score.
+// The playouts run in small batches as pool tasks, each batch draws from its own (seed, counter) stream,
+// so the result doesn't depend on the scheduling.
+class MonteCarloPlayer final
+{
+public:
+    static const int DEFAULT_ROLLOUTS = 1000;
+    static const int ROLLOUTS_PER_TASK = 16;
+
+    explicit MonteCarloPlayer(ThreadPool *pool = nullptr, std::uint64_t seed = 0);
+
+    int rollouts() const;
+    void setRollouts(int rollouts);
+
+    RolloutResult search(Board board);
+
+    // Random game from the board until no move is left, returns the score and counts the moves
+    static std::uint64_t rollout(Board board, RandomGenerator &random, std::uint64_t &moves);
+
+private:
+    ThreadPool *const m_pool;
+    const std::uint64_t m_seed;
+    std::uint64_t m_searches;
+    int m_rollouts;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // MONTECARLOPLAYER_H
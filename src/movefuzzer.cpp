@@ -0,0 +1,228 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "legacymove.h"
+#include "movefuzzer.h"
+#include "randomgenerator.h"
+#include "smallboardengine.h"
+
+#include <algorithm>
+#include <cassert>
+
+static const int MAX_PACKED_SIDE = 4;
+
+
+namespace Game {
+namespace Internal {
+
+static bool sameResult(const KernelResult &left, const KernelResult &right)
+{
+    return left.score == right.score && left.merges == right.merges && left.moves == right.moves;
+}
+
+
+static Board packBoard(const std::uint8_t *cells, int rows, int columns)
+{
+    Board board = 0;
+
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            board = BoardEngine::setExponent(board, row * BoardEngine::COLUMNS + column, cells[row * columns + column]);
+        }
+    }
+
+    return board;
+}
+
+
+static std::vector<std::uint8_t> unpackBoard(Board board, int rows, int columns)
+{
+    std::vector<std::uint8_t> cells(std::size_t(rows * columns));
+
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            cells[std::size_t(row * columns + column)] =
+                    std::uint8_t(BoardEngine::exponent(board, row * BoardEngine::COLUMNS + column));
+        }
+    }
+
+    return cells;
+}
+
+
+static void fillMismatch(MoveMismatch *mismatch, MoveEngine engine, Direction direction, const std::uint8_t *cells,
+                         int rows, int columns, const std::uint8_t *expectedCells, const KernelResult &expected,
+                         const std::uint8_t *actualCells, const KernelResult &actual)
+{
+    if (!mismatch) {
+        return;
+    }
+
+    const int cellsCount = rows * columns;
+
+    mismatch->engine = engine;
+    mismatch->direction = direction;
+    mismatch->rows = rows;
+    mismatch->columns = columns;
+    mismatch->cells.assign(cells, cells + cellsCount);
+    mismatch->expectedCells.assign(expectedCells, expectedCells + cellsCount);
+    mismatch->actualCells.assign(actualCells, actualCells + cellsCount);
+    mismatch->expected = expected;
+    mismatch->actual = actual;
+}
+
+
+// The packed engines report no moved tiles, so only the tiles, the score and the merges are compared
+static bool checkPacked(MoveEngine engine, const MoveResult &result, Direction direction, const std::uint8_t *cells,
+                        int rows, int columns, const std::uint8_t *expectedCells, const KernelResult &expected,
+                        MoveMismatch *mismatch)
+{
+    const auto actualCells = unpackBoard(result.board, rows, columns);
+    const KernelResult actual = { result.score, result.merges, expected.moves };
+
+    if (std::equal(actualCells.cbegin(), actualCells.cend(), expectedCells) && sameResult(expected, actual)) {
+        return true;
+    }
+
+    fillMismatch(mismatch, engine, direction, cells, rows, columns, expectedCells, expected, actualCells.data(), actual);
+    return false;
+}
+
+
+void MoveFuzzer::randomBoard(RandomGenerator &random, int maxSide, int &rows, int &columns,
+                             std::vector<std::uint8_t> &cells)
+{
+    assert(0 < maxSide);
+
+    const int maxBoardSide = (0 == random.bounded(2)) ? std::min(maxSide, MAX_PACKED_SIDE) : maxSide;
+    rows = 1 + int(random.bounded(std::uint32_t(maxBoardSide)));
+    columns = 1 + int(random.bounded(std::uint32_t(maxBoardSide)));
+
+    // Few distinct tiles and many of them make the merge chains the walks disagree on
+    const std::uint32_t maxExponent = 1 + random.bounded(MAX_EXPONENT);
+    const std::uint32_t emptyOdds = 1 + random.bounded(4);
+
+    cells.resize(std::size_t(rows * columns));
+    for (auto &cell : cells) {
+        cell = (0 == random.bounded(emptyOdds)) ? 0 : std::uint8_t(1 + random.bounded(maxExponent));
+    }
+}
+
+
+bool MoveFuzzer::check(const std::uint8_t *cells, int rows, int columns, MoveMismatch *mismatch)
+{
+    assert(0 < rows && 0 < columns);
+
+    const int cellsCount = rows * columns;
+    const Directions legalMoves = MoveKernels::legalMoves(cells, rows, columns);
+    const bool packed = rows <= MAX_PACKED_SIDE && columns <= MAX_PACKED_SIDE;
+    const bool vector = MoveKernels::hasVectorKernel() && rows <= MAX_VECTOR_SIDE && columns <= MAX_VECTOR_SIDE;
+    const SmallBoardEngine smallBoardEngine(packed ? rows : MAX_PACKED_SIDE, packed ? columns : MAX_PACKED_SIDE);
+    const Board board = packed ? packBoard(cells, rows, columns) : 0;
+
+    std::vector<std::uint8_t> expectedCells(cells, cells + cellsCount);
+    std::vector<std::uint8_t> actualCells(cells, cells + cellsCount);
+
+    for (int move = 0; move < 4; ++move) {
+        const Direction direction = Direction(move);
+
+        std::copy(cells, cells + cellsCount, expectedCells.begin());
+        const KernelResult expected = LegacyMove::move(expectedCells.data(), rows, columns, direction);
+
+        const struct
+        {
+            MoveEngine engine;
+            MoveKernel kernel;
+        } kernels[] = {
+            { MoveEngine::Cells, &MoveKernels::moveCells },
+            { MoveEngine::Kernel, MoveKernels::kernel(rows, columns) },
+            { MoveEngine::Vector, vector ? &MoveKernels::moveVectorCells : nullptr }
+        };
+
+        for (const auto &kernel : kernels) {
+            if (!kernel.kernel) {
+                continue;
+            }
+
+            std::copy(cells, cells + cellsCount, actualCells.begin());
+            const KernelResult actual = kernel.kernel(actualCells.data(), rows, columns, direction, nullptr);
+
+            if (actualCells != expectedCells || !sameResult(expected, actual)) {
+                fillMismatch(mismatch, kernel.engine, direction, cells, rows, columns,
+                             expectedCells.data(), expected, actualCells.data(), actual);
+                return false;
+            }
+        }
+
+        // Every tile the walk moves leaves its cell, so a move is legal exactly when it moves a tile
+        const bool legal = 0 != (legalMoves & BoardEngine::directionBit(direction));
+        if (legal != (0 < expected.moves)) {
+            const KernelResult expectedLegal = { 0, 0, 0 < expected.moves ? 1 : 0 };
+            const KernelResult actualLegal = { 0, 0, legal ? 1 : 0 };
+            fillMismatch(mismatch, MoveEngine::LegalMoves, direction, cells, rows, columns,
+                         expectedCells.data(), expectedLegal, cells, actualLegal);
+            return false;
+        }
+
+        if (!packed) {
+            continue;
+        }
+
+        if (!checkPacked(MoveEngine::SmallBoard, smallBoardEngine.move(board, direction), direction,
+                         cells, rows, columns, expectedCells.data(), expected, mismatch)) {
+            return false;
+        }
+
+        if (BoardEngine::ROWS == rows && BoardEngine::COLUMNS == columns
+                && !checkPacked(MoveEngine::Board, BoardEngine::move(board, direction), direction,
+                                cells, rows, columns, expectedCells.data(), expected, mismatch)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+const char *MoveFuzzer::engineName(MoveEngine engine)
+{
+    switch (engine) {
+    case MoveEngine::Cells:
+        return "generic kernel";
+    case MoveEngine::Kernel:
+        return "dispatched kernel";
+    case MoveEngine::Vector:
+        return "vector kernel";
+    case MoveEngine::LegalMoves:
+        return "legal moves";
+    case MoveEngine::SmallBoard:
+        return "small board engine";
+    case MoveEngine::Board:
+        return "board engine";
+    }
+
+    assert(false);
+    return "";
+}
+
+} // namespace Internal
+} // namespace Game
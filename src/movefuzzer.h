@@ -0,0 +1,91 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef MOVEFUZZER_H
+#define MOVEFUZZER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "boardengine.h"
+#include "movekernel.h"
+
+
+namespace Game {
+namespace Internal {
+
+class RandomGenerator;
+
+enum class MoveEngine
+{
+    // The generic, the size-dispatched and the SSE4.1 kernels
+    Cells,
+    Kernel,
+    Vector,
+    // The legal moves of the kernels
+    LegalMoves,
+    // The packed engines of boards up to 4x4
+    SmallBoard,
+    Board
+};
+
+struct MoveMismatch
+{
+    MoveEngine engine;
+    Direction direction;
+    int rows;
+    int columns;
+    // Row-major tile exponents before and after the move
+    std::vector<std::uint8_t> cells;
+    std::vector<std::uint8_t> expectedCells;
+    std::vector<std::uint8_t> actualCells;
+    // Legal moves only set the moved tiles, to 1 for a legal move and 0 otherwise
+    KernelResult expected;
+    KernelResult actual;
+};
+
+// Moves boards of any size with the legacy cell walk and with every engine which plays them,
+// a board passes when all of them agree on the tiles, the score, the merges and the moved tiles.
+class MoveFuzzer final
+{
+public:
+    // The packed engines don't merge 32768 tiles, so no generated tile is one
+    static const int MAX_EXPONENT = BoardEngine::MAX_EXPONENT - 1;
+    static const int MAX_VECTOR_SIDE = 16;
+
+    // Half of the boards are up to 4x4 ones, so the packed engines get their share
+    static void randomBoard(RandomGenerator &random, int maxSide, int &rows, int &columns,
+                            std::vector<std::uint8_t> &cells);
+
+    // Returns false and fills mismatch, when it isn't null, on the first difference
+    static bool check(const std::uint8_t *cells, int rows, int columns, MoveMismatch *mismatch);
+
+    static const char *engineName(MoveEngine engine);
+
+private:
+    MoveFuzzer() = delete;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // MOVEFUZZER_H
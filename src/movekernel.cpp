@@ -0,0 +1,349 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "movekernel.h"
+
+#include <algorithm>
+#include <cassert>
+
+// Shorter lines are moved as fast by the scalar kernels
+static const int MIN_VECTOR_LINE_LENGTH = 7;
+static const int MAX_VECTOR_LINE_LENGTH = 16;
+
+
+namespace Game {
+namespace Internal {
+
+namespace {
+
+template<int Rows, int Columns, Direction LineDirection>
+struct FixedGeometry
+{
+    static constexpr bool horizontal() { return Direction::Left == LineDirection || Direction::Right == LineDirection; }
+    static constexpr int cells() { return Rows * Columns; }
+    static constexpr int lines() { return horizontal() ? Rows : Columns; }
+    static constexpr int length() { return horizontal() ? Columns : Rows; }
+
+    static constexpr int step()
+    {
+        return Direction::Left == LineDirection ? 1
+             : Direction::Right == LineDirection ? -1
+             : Direction::Up == LineDirection ? Columns : -Columns;
+    }
+
+    static constexpr int lineStart(int line)
+    {
+        return Direction::Left == LineDirection ? line * Columns
+             : Direction::Right == LineDirection ? line * Columns + Columns - 1
+             : Direction::Up == LineDirection ? line : (Rows - 1) * Columns + line;
+    }
+};
+
+
+class RuntimeGeometry
+{
+public:
+    RuntimeGeometry(int rows, int columns, Direction direction) :
+        m_rows(rows),
+        m_columns(columns),
+        m_direction(direction)
+    {
+    }
+
+    bool horizontal() const { return Direction::Left == m_direction || Direction::Right == m_direction; }
+    int cells() const { return m_rows * m_columns; }
+    int lines() const { return horizontal() ? m_rows : m_columns; }
+    int length() const { return horizontal() ? m_columns : m_rows; }
+
+    int step() const
+    {
+        switch (m_direction) {
+        case Direction::Left:
+            return 1;
+        case Direction::Right:
+            return -1;
+        case Direction::Up:
+            return m_columns;
+        case Direction::Down:
+            return -m_columns;
+        }
+
+        assert(false);
+        return 0;
+    }
+
+    int lineStart(int line) const
+    {
+        switch (m_direction) {
+        case Direction::Left:
+            return line * m_columns;
+        case Direction::Right:
+            return line * m_columns + m_columns - 1;
+        case Direction::Up:
+            return line;
+        case Direction::Down:
+            return (m_rows - 1) * m_columns + line;
+        }
+
+        assert(false);
+        return 0;
+    }
+
+private:
+    const int m_rows;
+    const int m_columns;
+    const Direction m_direction;
+};
+
+
+// Shared slide and merge rules, the geometry decides whether the loop bounds are compile-time constants
+template<typename Geometry>
+KernelResult moveLines(const Geometry &geometry, std::uint8_t *cells, std::int16_t *targets)
+{
+    KernelResult result = { 0, 0, 0 };
+
+    if (targets) {
+        std::fill(targets, targets + geometry.cells(), std::int16_t(-1));
+    }
+
+    const int step = geometry.step();
+
+    for (int line = 0; line < geometry.lines(); ++line) {
+        const int lineStart = geometry.lineStart(line);
+        int targetPosition = 0;
+        int previousExponent = 0;
+
+        for (int position = 0; position < geometry.length(); ++position) {
+            const int cell = lineStart + position * step;
+            const int exponent = cells[cell];
+
+            if (0 == exponent) {
+                continue;
+            }
+
+            cells[cell] = 0;
+
+            int targetCell = 0;
+            if (exponent == previousExponent) {
+                targetCell = lineStart + (targetPosition - 1) * step;
+                cells[targetCell] = std::uint8_t(exponent + 1);
+                result.score += 1 << (exponent + 1);
+                ++result.merges;
+                previousExponent = 0;
+            } else {
+                targetCell = lineStart + targetPosition * step;
+                cells[targetCell] = std::uint8_t(exponent);
+                previousExponent = exponent;
+                ++targetPosition;
+            }
+
+            if (targetCell != cell) {
+                ++result.moves;
+            }
+
+            if (targets) {
+                targets[cell] = std::int16_t(targetCell);
+            }
+        }
+    }
+
+    return result;
+}
+
+} // namespace
+
+
+MoveKernel MoveKernels::kernel(int rows, int columns)
+{
+    if (rows == columns) {
+        switch (rows) {
+        case 3:
+            return &moveFixedCells<3, 3>;
+        case 4:
+            return &moveFixedCells<4, 4>;
+        case 5:
+            return &moveFixedCells<5, 5>;
+        case 6:
+            return &moveFixedCells<6, 6>;
+        default:
+            break;
+        }
+    }
+
+    const int longestLine = std::max(rows, columns);
+    if (MIN_VECTOR_LINE_LENGTH <= longestLine && longestLine <= MAX_VECTOR_LINE_LENGTH && hasVectorKernel()) {
+        return &moveVectorCells;
+    }
+
+    if (8 == rows && 8 == columns) {
+        return &moveFixedCells<8, 8>;
+    }
+
+    return &moveCells;
+}
+
+
+KernelResult MoveKernels::moveCells(std::uint8_t *cells, int rows, int columns,
+                                    Direction direction, std::int16_t *targets)
+{
+    return moveLines(RuntimeGeometry(rows, columns, direction), cells, targets);
+}
+
+
+template<int Rows, int Columns>
+KernelResult MoveKernels::moveFixedCells(std::uint8_t *cells, int rows, int columns,
+                                         Direction direction, std::int16_t *targets)
+{
+    assert(Rows == rows && Columns == columns);
+    (void)rows;
+    (void)columns;
+
+    switch (direction) {
+    case Direction::Left:
+        return moveLines(FixedGeometry<Rows, Columns, Direction::Left>(), cells, targets);
+    case Direction::Right:
+        return moveLines(FixedGeometry<Rows, Columns, Direction::Right>(), cells, targets);
+    case Direction::Up:
+        return moveLines(FixedGeometry<Rows, Columns, Direction::Up>(), cells, targets);
+    case Direction::Down:
+        return moveLines(FixedGeometry<Rows, Columns, Direction::Down>(), cells, targets);
+    }
+
+    assert(false);
+    return KernelResult();
+}
+
+
+void MoveKernels::moveEvents(const std::int16_t *targets, const std::uint8_t *cells, int rows, int columns,
+                             Direction direction, MoveEvents &events)
+{
+    const int linesCount = lines(direction, rows, columns);
+    const int length = lineLength(direction, rows, columns);
+
+    for (int line = 0; line < linesCount; ++line) {
+        int previousCell = -1;
+        int previousTarget = -1;
+        int previousEvent = -1;
+
+        for (int position = 0; position < length; ++position) {
+            const int cell = lineCell(direction, rows, columns, line, position);
+            const int target = targets[cell];
+
+            if (target < 0) {
+                continue;
+            }
+
+            if (target == previousTarget) {
+                const MoveEvent event = { MoveEventType::Merge, cells[target], std::int16_t(previousCell),
+                                          std::int16_t(cell), std::int16_t(target) };
+                if (0 <= previousEvent) {
+                    events[std::size_t(previousEvent)] = event;
+                } else {
+                    events.push_back(event);
+                }
+                previousTarget = -1;
+                continue;
+            }
+
+            previousCell = cell;
+            previousTarget = target;
+            previousEvent = -1;
+
+            if (target != cell) {
+                previousEvent = int(events.size());
+                events.push_back({ MoveEventType::Slide, cells[target], std::int16_t(cell), -1, std::int16_t(target) });
+            }
+        }
+    }
+}
+
+
+Directions MoveKernels::legalMoves(const std::uint8_t *cells, int rows, int columns)
+{
+    const Directions all = Directions(BoardEngine::directionBit(Direction::Left) | BoardEngine::directionBit(Direction::Right) |
+                                      BoardEngine::directionBit(Direction::Up) | BoardEngine::directionBit(Direction::Down));
+    Directions result = 0;
+
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            const int cell = row * columns + column;
+            const int exponent = cells[cell];
+
+            if (column + 1 < columns) {
+                const int right = cells[cell + 1];
+                if (0 != exponent && exponent == right) {
+                    result |= Directions(BoardEngine::directionBit(Direction::Left) | BoardEngine::directionBit(Direction::Right));
+                } else if (0 == exponent && 0 != right) {
+                    result |= BoardEngine::directionBit(Direction::Left);
+                } else if (0 != exponent && 0 == right) {
+                    result |= BoardEngine::directionBit(Direction::Right);
+                }
+            }
+
+            if (row + 1 < rows) {
+                const int bottom = cells[cell + columns];
+                if (0 != exponent && exponent == bottom) {
+                    result |= Directions(BoardEngine::directionBit(Direction::Up) | BoardEngine::directionBit(Direction::Down));
+                } else if (0 == exponent && 0 != bottom) {
+                    result |= BoardEngine::directionBit(Direction::Up);
+                } else if (0 != exponent && 0 == bottom) {
+                    result |= BoardEngine::directionBit(Direction::Down);
+                }
+            }
+        }
+
+        if (all == result) {
+            break;
+        }
+    }
+
+    return result;
+}
+
+
+int MoveKernels::lines(Direction direction, int rows, int columns)
+{
+    return RuntimeGeometry(rows, columns, direction).lines();
+}
+
+
+int MoveKernels::lineLength(Direction direction, int rows, int columns)
+{
+    return RuntimeGeometry(rows, columns, direction).length();
+}
+
+
+int MoveKernels::lineCell(Direction direction, int rows, int columns, int line, int position)
+{
+    const RuntimeGeometry geometry(rows, columns, direction);
+    return geometry.lineStart(line) + position * geometry.step();
+}
+
+
+template KernelResult MoveKernels::moveFixedCells<3, 3>(std::uint8_t *, int, int, Direction, std::int16_t *);
+template KernelResult MoveKernels::moveFixedCells<4, 4>(std::uint8_t *, int, int, Direction, std::int16_t *);
+template KernelResult MoveKernels::moveFixedCells<5, 5>(std::uint8_t *, int, int, Direction, std::int16_t *);
+template KernelResult MoveKernels::moveFixedCells<6, 6>(std::uint8_t *, int, int, Direction, std::int16_t *);
+template KernelResult MoveKernels::moveFixedCells<8, 8>(std::uint8_t *, int, int, Direction, std::int16_t *);
+
+} // namespace Internal
+} // namespace Game
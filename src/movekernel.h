@@ -0,0 +1,102 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef MOVEKERNEL_H
+#define MOVEKERNEL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "boardengine.h"
+
+
+namespace Game {
+namespace Internal {
+
+struct KernelResult
+{
+    int score;
+    int merges;
+    int moves;
+};
+
+enum class MoveEventType : std::uint8_t
+{
+    Slide,
+    Merge,
+    Spawn
+};
+
+// Slide moves the tile of source to target. Merge moves the tiles of source and partner to target,
+// where the tile of partner survives. Spawn creates a tile in target. Exponent is the target one after the event.
+struct MoveEvent
+{
+    MoveEventType type;
+    std::uint8_t exponent;
+    std::int16_t source;
+    std::int16_t partner;
+    std::int16_t target;
+};
+
+using MoveEvents = std::vector<MoveEvent>;
+
+// Moves the row-major tile exponents of a rows x columns board in place.
+// When targets is not null it receives the new cell of every tile, -1 for empty cells.
+using MoveKernel = KernelResult (*)(std::uint8_t *cells, int rows, int columns,
+                                    Direction direction, std::int16_t *targets);
+
+class MoveKernels final
+{
+public:
+    static MoveKernel kernel(int rows, int columns);
+
+    static KernelResult moveCells(std::uint8_t *cells, int rows, int columns,
+                                  Direction direction, std::int16_t *targets);
+
+    template<int Rows, int Columns>
+    static KernelResult moveFixedCells(std::uint8_t *cells, int rows, int columns,
+                                       Direction direction, std::int16_t *targets);
+
+    // SSE4.1 kernel for boards up to 16x16, falls back to moveCells() where it isn't compiled in
+    static bool hasVectorKernel();
+    static KernelResult moveVectorCells(std::uint8_t *cells, int rows, int columns,
+                                        Direction direction, std::int16_t *targets);
+
+    // Appends the events of a move in the order they can be applied, starting from the wall.
+    // Cells are the exponents after the move, targets are the ones the kernel returned.
+    static void moveEvents(const std::int16_t *targets, const std::uint8_t *cells, int rows, int columns,
+                           Direction direction, MoveEvents &events);
+
+    static Directions legalMoves(const std::uint8_t *cells, int rows, int columns);
+
+    static int lines(Direction direction, int rows, int columns);
+    static int lineLength(Direction direction, int rows, int columns);
+    static int lineCell(Direction direction, int rows, int columns, int line, int position);
+
+private:
+    MoveKernels() = delete;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // MOVEKERNEL_H
@@ -0,0 +1,190 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "ntuplenetwork.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const char WEIGHTS_FILE_MAGIC[8] = { '2', '0', '4', '8', 'N', 'T', 'N', '\0' };
+static const std::uint32_t WEIGHTS_FILE_VERSION = 1;
+// Written in the native order, a file from a machine of the other endianness reads it reversed
+static const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const std::size_t WEIGHTS_CHUNK_SIZE = 1 << 16;
+
+static const int CELL_BITS = 4;
+static const std::uint8_t TUPLES[4][6] = {
+    { 0, 1, 2, 3, 4, 5 },
+    { 4, 5, 6, 7, 8, 9 },
+    { 0, 1, 2, 4, 5, 6 },
+    { 4, 5, 6, 8, 9, 10 }
+};
+
+
+namespace Game {
+namespace Internal {
+
+namespace {
+
+struct WeightsFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrderMark;
+    std::uint32_t tuplesCount;
+    std::uint32_t tupleLength;
+    std::uint8_t tuples[NTupleNetwork::TUPLES_COUNT][NTupleNetwork::TUPLE_LENGTH];
+};
+
+} // namespace
+
+
+static WeightsFileHeader weightsFileHeader()
+{
+    WeightsFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, WEIGHTS_FILE_MAGIC, sizeof(header.magic));
+    header.version = WEIGHTS_FILE_VERSION;
+    header.byteOrderMark = BYTE_ORDER_MARK;
+    header.tuplesCount = NTupleNetwork::TUPLES_COUNT;
+    header.tupleLength = NTupleNetwork::TUPLE_LENGTH;
+    std::memcpy(header.tuples, TUPLES, sizeof(header.tuples));
+    return header;
+}
+
+
+NTupleNetwork::NTupleNetwork() :
+    m_weights(new std::atomic<float>[TUPLES_COUNT * TUPLE_WEIGHTS])
+{
+    clear();
+}
+
+
+NTupleNetwork::~NTupleNetwork() = default;
+
+
+float NTupleNetwork::evaluate(Board board) const
+{
+    Features indices;
+    features(board, indices);
+
+    float result = 0.0f;
+    for (const std::size_t index : indices) {
+        result += m_weights[index].load(std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+
+void NTupleNetwork::update(Board board, float delta)
+{
+    Features indices;
+    features(board, indices);
+
+    for (const std::size_t index : indices) {
+        std::atomic<float> &weight = m_weights[index];
+        weight.store(weight.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+}
+
+
+void NTupleNetwork::clear()
+{
+    for (std::size_t index = 0; index < TUPLES_COUNT * TUPLE_WEIGHTS; ++index) {
+        m_weights[index].store(0.0f, std::memory_order_relaxed);
+    }
+}
+
+
+bool NTupleNetwork::save(const std::string &fileName) const
+{
+    std::FILE *file = std::fopen(fileName.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    const WeightsFileHeader header = weightsFileHeader();
+    bool ok = (1 == std::fwrite(&header, sizeof(header), 1, file));
+
+    std::vector<float> chunk(WEIGHTS_CHUNK_SIZE);
+    for (std::size_t offset = 0; ok && offset < TUPLES_COUNT * TUPLE_WEIGHTS; offset += WEIGHTS_CHUNK_SIZE) {
+        for (std::size_t i = 0; i < WEIGHTS_CHUNK_SIZE; ++i) {
+            chunk[i] = m_weights[offset + i].load(std::memory_order_relaxed);
+        }
+        ok = (WEIGHTS_CHUNK_SIZE == std::fwrite(chunk.data(), sizeof(float), WEIGHTS_CHUNK_SIZE, file));
+    }
+
+    return (0 == std::fclose(file)) && ok;
+}
+
+
+bool NTupleNetwork::load(const std::string &fileName)
+{
+    std::FILE *file = std::fopen(fileName.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    const WeightsFileHeader expected = weightsFileHeader();
+    WeightsFileHeader header;
+    bool ok = (1 == std::fread(&header, sizeof(header), 1, file)) && (0 == std::memcmp(&header, &expected, sizeof(header)));
+
+    std::vector<float> chunk(WEIGHTS_CHUNK_SIZE);
+    for (std::size_t offset = 0; ok && offset < TUPLES_COUNT * TUPLE_WEIGHTS; offset += WEIGHTS_CHUNK_SIZE) {
+        ok = (WEIGHTS_CHUNK_SIZE == std::fread(chunk.data(), sizeof(float), WEIGHTS_CHUNK_SIZE, file));
+        for (std::size_t i = 0; ok && i < WEIGHTS_CHUNK_SIZE; ++i) {
+            m_weights[offset + i].store(chunk[i], std::memory_order_relaxed);
+        }
+    }
+
+    std::fclose(file);
+
+    if (!ok) {
+        clear();
+    }
+
+    return ok;
+}
+
+
+void NTupleNetwork::features(Board board, Features &result)
+{
+    std::size_t feature = 0;
+
+    for (int symmetry = 0; symmetry < BoardEngine::SYMMETRIES; ++symmetry) {
+        const Board symmetric = BoardEngine::symmetry(board, symmetry);
+
+        for (int tuple = 0; tuple < TUPLES_COUNT; ++tuple) {
+            std::size_t index = 0;
+            for (int cell = 0; cell < TUPLE_LENGTH; ++cell) {
+                const std::size_t exponent = (symmetric >> (CELL_BITS * TUPLES[tuple][cell])) & 0xF;
+                index |= exponent << (CELL_BITS * cell);
+            }
+            result[feature++] = std::size_t(tuple) * TUPLE_WEIGHTS + index;
+        }
+    }
+}
+
+} // namespace Internal
+} // namespace Game
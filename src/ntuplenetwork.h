@@ -0,0 +1,73 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef NTUPLENETWORK_H
+#define NTUPLENETWORK_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "boardengine.h"
+
+
+namespace Game {
+namespace Internal {
+
+// Afterstate value function of four 6-cell tuples, each one sampled on all 8 symmetries of the board.
+// Weights are read and written with relaxed atomics, so training threads update them Hogwild style.
+class NTupleNetwork final
+{
+public:
+    static const int TUPLES_COUNT = 4;
+    static const int TUPLE_LENGTH = 6;
+    static const std::size_t TUPLE_WEIGHTS = std::size_t(1) << (4 * TUPLE_LENGTH);
+
+    NTupleNetwork();
+    ~NTupleNetwork();
+
+    float evaluate(Board board) const;
+    // Adds delta to every weight the board reads
+    void update(Board board, float delta);
+
+    void clear();
+
+    bool save(const std::string &fileName) const;
+    bool load(const std::string &fileName);
+
+private:
+    NTupleNetwork(const NTupleNetwork &) = delete;
+    NTupleNetwork &operator=(const NTupleNetwork &) = delete;
+
+    using Features = std::array<std::size_t, TUPLES_COUNT * BoardEngine::SYMMETRIES>;
+
+    static void features(Board board, Features &result);
+
+    std::unique_ptr<std::atomic<float>[]> m_weights;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // NTUPLENETWORK_H
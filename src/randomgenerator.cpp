@@ -0,0 +1,152 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "randomgenerator.h"
+
+#include <cassert>
+#include <random>
+
+static const std::uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+
+
+namespace Game {
+namespace Internal {
+
+static std::uint64_t splitMix(std::uint64_t &value)
+{
+    std::uint64_t result = (value += GOLDEN_GAMMA);
+    result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    result = (result ^ (result >> 27)) * 0x94D049BB133111EBULL;
+    return result ^ (result >> 31);
+}
+
+
+static std::uint64_t rotateLeft(std::uint64_t value, int shift)
+{
+    return (value << shift) | (value >> (64 - shift));
+}
+
+
+RandomGenerator::RandomGenerator(std::uint64_t seed, std::uint64_t counter)
+{
+    this->seed(seed, counter);
+}
+
+
+std::uint64_t RandomGenerator::randomSeed()
+{
+    std::random_device device;
+    return (std::uint64_t(device()) << 32) ^ std::uint64_t(device());
+}
+
+
+void RandomGenerator::seed(std::uint64_t seed, std::uint64_t counter)
+{
+    std::uint64_t value = seed;
+    value = splitMix(value) ^ counter;
+
+    for (auto &word : m_state) {
+        word = splitMix(value);
+    }
+}
+
+
+std::uint64_t RandomGenerator::next()
+{
+    const std::uint64_t result = rotateLeft(m_state[1] * 5, 7) * 9;
+    const std::uint64_t t = m_state[1] << 17;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = rotateLeft(m_state[3], 45);
+
+    return result;
+}
+
+
+std::uint32_t RandomGenerator::bounded(std::uint32_t range)
+{
+    assert(0 < range);
+
+    std::uint64_t product = (next() >> 32) * range;
+    std::uint32_t low = std::uint32_t(product);
+
+    if (low < range) {
+        const std::uint32_t threshold = std::uint32_t(-range) % range;
+        while (low < threshold) {
+            product = (next() >> 32) * range;
+            low = std::uint32_t(product);
+        }
+    }
+
+    return std::uint32_t(product >> 32);
+}
+
+
+void RandomGenerator::jump()
+{
+    jump({{ 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL }});
+}
+
+
+void RandomGenerator::longJump()
+{
+    jump({{ 0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL, 0x77710069854EE241ULL, 0x39109BB02ACBE635ULL }});
+}
+
+
+const RandomGenerator::State &RandomGenerator::state() const
+{
+    return m_state;
+}
+
+
+void RandomGenerator::setState(const State &state)
+{
+    assert(0 != (state[0] | state[1] | state[2] | state[3]));
+    m_state = state;
+}
+
+
+void RandomGenerator::jump(const State &polynomial)
+{
+    State state = {{ 0, 0, 0, 0 }};
+
+    for (const std::uint64_t word : polynomial) {
+        for (int bit = 0; bit < 64; ++bit) {
+            if (0 != (word & (std::uint64_t(1) << bit))) {
+                for (std::size_t i = 0; i < state.size(); ++i) {
+                    state[i] ^= m_state[i];
+                }
+            }
+            next();
+        }
+    }
+
+    m_state = state;
+}
+
+} // namespace Internal
+} // namespace Game
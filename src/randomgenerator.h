@@ -0,0 +1,65 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef RANDOMGENERATOR_H
+#define RANDOMGENERATOR_H
+
+#include <array>
+#include <cstdint>
+
+
+namespace Game {
+namespace Internal {
+
+// xoshiro256** generator. Every (seed, counter) pair gives its own reproducible stream,
+// jump() and longJump() split one stream into 2^128 and 2^64 long non-overlapping ones.
+class RandomGenerator final
+{
+public:
+    using State = std::array<std::uint64_t, 4>;
+
+    explicit RandomGenerator(std::uint64_t seed = 0, std::uint64_t counter = 0);
+
+    static std::uint64_t randomSeed();
+
+    void seed(std::uint64_t seed, std::uint64_t counter = 0);
+
+    std::uint64_t next();
+    // Unbiased integer in [0, range)
+    std::uint32_t bounded(std::uint32_t range);
+
+    void jump();
+    void longJump();
+
+    const State &state() const;
+    void setState(const State &state);
+
+private:
+    void jump(const State &polynomial);
+
+    State m_state;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // RANDOMGENERATOR_H
@@ -0,0 +1,235 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "movekernel.h"
+#include "randomgenerator.h"
+#include "replayverifier.h"
+
+#include <algorithm>
+#include <cassert>
+
+static const int MOVE_DIRECTION_NONE_VALUE = 0;
+static const int MOVE_DIRECTION_DOWN_VALUE = 4;
+static const int SEEDLESS_GAME_SEED = 0;
+static const int WIN_EXPONENT = 11;
+
+
+namespace Game {
+namespace Internal {
+
+static bool isSpawnExponent(int exponent)
+{
+    return 1 == exponent || 2 == exponent;
+}
+
+
+static bool hasWinTile(const std::vector<std::uint8_t> &cells)
+{
+    return std::any_of(cells.cbegin(), cells.cend(), [](std::uint8_t cell) {
+        return WIN_EXPONENT <= cell;
+    });
+}
+
+
+ReplayVerifier::ReplayVerifier(int rows, int columns, std::uint64_t seed) :
+    m_rows(rows),
+    m_columns(columns),
+    m_seed(seed),
+    m_cells(std::size_t(rows * columns), 0),
+    m_turnId(FIRST_PARENT_TURN_ID),
+    m_score(0),
+    m_turns(0),
+    m_started(false)
+{
+    assert(0 < rows && 0 < columns);
+}
+
+
+int ReplayVerifier::rows() const
+{
+    return m_rows;
+}
+
+
+int ReplayVerifier::columns() const
+{
+    return m_columns;
+}
+
+
+std::uint64_t ReplayVerifier::turns() const
+{
+    return m_turns;
+}
+
+
+ReplayIssues ReplayVerifier::verify(const ReplayTurn &turn)
+{
+    assert(turn.cells.size() == m_cells.size());
+    ++m_turns;
+
+    ReplayIssues issues = turn.validTiles ? 0 : issueBit(ReplayIssue::BadTile);
+
+    if (FIRST_PARENT_TURN_ID == turn.parentTurnId) {
+        issues |= verifyStart(turn);
+    } else if (!m_started || turn.parentTurnId != m_turnId) {
+        issues |= issueBit(ReplayIssue::BrokenChain);
+    } else if (turn.moveDirection <= MOVE_DIRECTION_NONE_VALUE || MOVE_DIRECTION_DOWN_VALUE < turn.moveDirection) {
+        issues |= issueBit(ReplayIssue::BadDirection);
+    } else if (turn.validTiles) {
+        issues |= verifyMove(turn);
+    }
+
+    // The stored turn is the parent of the next one, whatever its issues
+    m_cells = turn.cells;
+    m_turnId = turn.turnId;
+    m_score = turn.score;
+    m_started = true;
+
+    return issues;
+}
+
+
+ReplayIssues ReplayVerifier::issueBit(ReplayIssue issue)
+{
+    return ReplayIssues(1 << int(issue));
+}
+
+
+const char *ReplayVerifier::issueName(ReplayIssue issue)
+{
+    switch (issue) {
+    case ReplayIssue::BrokenChain:
+        return "broken chain";
+    case ReplayIssue::BadTile:
+        return "bad tile";
+    case ReplayIssue::BadDirection:
+        return "bad direction";
+    case ReplayIssue::IllegalMove:
+        return "illegal move";
+    case ReplayIssue::TileMismatch:
+        return "tile mismatch";
+    case ReplayIssue::SpawnMismatch:
+        return "spawn mismatch";
+    case ReplayIssue::ScoreMismatch:
+        return "score mismatch";
+    }
+
+    assert(false);
+    return "";
+}
+
+
+ReplayIssues ReplayVerifier::verifyStart(const ReplayTurn &turn) const
+{
+    ReplayIssues issues = 0;
+
+    if (MOVE_DIRECTION_NONE_VALUE != turn.moveDirection) {
+        issues |= issueBit(ReplayIssue::BadDirection);
+    }
+
+    if (0 != turn.score) {
+        issues |= issueBit(ReplayIssue::ScoreMismatch);
+    }
+
+    const auto tilesCount = std::count_if(turn.cells.cbegin(), turn.cells.cend(), [](std::uint8_t cell) {
+        return 0 != cell;
+    });
+    const bool spawned = std::all_of(turn.cells.cbegin(), turn.cells.cend(), [](std::uint8_t cell) {
+        return 0 == cell || isSpawnExponent(cell);
+    });
+
+    if (START_TILES_COUNT != tilesCount || !spawned) {
+        return issues | issueBit(ReplayIssue::TileMismatch);
+    }
+
+    if (SEEDLESS_GAME_SEED != m_seed) {
+        std::vector<std::uint8_t> cells(m_cells.size(), 0);
+        RandomGenerator random(m_seed, std::uint64_t(turn.turnId));
+
+        for (int i = 0; i < START_TILES_COUNT; ++i) {
+            BoardEngine::spawnRandomTile(cells.data(), int(cells.size()), random);
+        }
+
+        if (cells != turn.cells) {
+            issues |= issueBit(ReplayIssue::SpawnMismatch);
+        }
+    }
+
+    return issues;
+}
+
+
+ReplayIssues ReplayVerifier::verifyMove(const ReplayTurn &turn)
+{
+    ReplayIssues issues = 0;
+
+    const Direction direction = Direction(turn.moveDirection - 1);
+    std::vector<std::uint8_t> cells = m_cells;
+    const KernelResult result = MoveKernels::moveCells(cells.data(), m_rows, m_columns, direction, nullptr);
+
+    if (0 == result.moves) {
+        return issueBit(ReplayIssue::IllegalMove);
+    }
+
+    if (m_score + result.score != turn.score) {
+        issues |= issueBit(ReplayIssue::ScoreMismatch);
+    }
+
+    // Every cell but the spawned one keeps the moved tile
+    int spawnedCells = 0;
+    for (std::size_t cell = 0; cell < cells.size(); ++cell) {
+        if (cells[cell] == turn.cells[cell]) {
+            continue;
+        }
+
+        if (0 != cells[cell] || !isSpawnExponent(turn.cells[cell])) {
+            return issues | issueBit(ReplayIssue::TileMismatch);
+        }
+
+        ++spawnedCells;
+    }
+
+    // The first 2048 stops the game without a spawn, a Continue later rewrites the turn with it
+    const bool win = !hasWinTile(m_cells) && hasWinTile(cells);
+    if (win && 0 == spawnedCells) {
+        return issues;
+    }
+
+    if (1 != spawnedCells) {
+        return issues | issueBit(ReplayIssue::TileMismatch);
+    }
+
+    if (SEEDLESS_GAME_SEED != m_seed) {
+        RandomGenerator random(m_seed, std::uint64_t(turn.turnId));
+        BoardEngine::spawnRandomTile(cells.data(), int(cells.size()), random);
+
+        if (cells != turn.cells) {
+            issues |= issueBit(ReplayIssue::SpawnMismatch);
+        }
+    }
+
+    return issues;
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,106 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef REPLAYVERIFIER_H
+#define REPLAYVERIFIER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "boardengine.h"
+
+
+namespace Game {
+namespace Internal {
+
+enum class ReplayIssue
+{
+    // The parent isn't the turn before, the turn can't be replayed
+    BrokenChain,
+    // The cell or the value of a stored tile is out of the board rules
+    BadTile,
+    // The stored direction isn't a move, or the first turn has one
+    BadDirection,
+    // The move doesn't change the parent board
+    IllegalMove,
+    // The tiles aren't the moved parent board with one new 2 or 4, or with none on the winning move
+    TileMismatch,
+    // The new tiles aren't the ones the game seed spawns for the turn
+    SpawnMismatch,
+    // The score isn't the parent one plus the merges of the move
+    ScoreMismatch
+};
+
+// Bit (1 << ReplayIssue) is set for every issue of a turn
+using ReplayIssues = std::uint8_t;
+
+struct ReplayTurn
+{
+    std::int64_t turnId;
+    std::int64_t parentTurnId;
+    // As stored: 0 for none, then left, right, up and down
+    int moveDirection;
+    std::int64_t score;
+    // Row-major tile exponents
+    std::vector<std::uint8_t> cells;
+    bool validTiles;
+};
+
+// Replays the stored turns of one game against the move rules. Only the last turn is kept,
+// undone turns are removed from the storage, so every parent is the turn before.
+class ReplayVerifier final
+{
+public:
+    static const int START_TILES_COUNT = 2;
+    static const std::int64_t FIRST_PARENT_TURN_ID = 0;
+
+    // Games stored before the seed was saved have seed 0, their spawns are only checked for shape
+    ReplayVerifier(int rows, int columns, std::uint64_t seed);
+
+    int rows() const;
+    int columns() const;
+    std::uint64_t turns() const;
+
+    // The turns have to come in the order of their ids
+    ReplayIssues verify(const ReplayTurn &turn);
+
+    static ReplayIssues issueBit(ReplayIssue issue);
+    static const char *issueName(ReplayIssue issue);
+
+private:
+    ReplayIssues verifyStart(const ReplayTurn &turn) const;
+    ReplayIssues verifyMove(const ReplayTurn &turn);
+
+    const int m_rows;
+    const int m_columns;
+    const std::uint64_t m_seed;
+    std::vector<std::uint8_t> m_cells;
+    std::int64_t m_turnId;
+    std::int64_t m_score;
+    std::uint64_t m_turns;
+    bool m_started;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // REPLAYVERIFIER_H
@@ -0,0 +1,207 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "simulationshard.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+static const char SIMULATION_FILE_MAGIC[8] = { '2', '0', '4', '8', 'S', 'I', 'M', '\0' };
+static const std::uint32_t SIMULATION_FILE_VERSION = 1;
+// Values are written in the native order, a file from a machine of the other endianness is rejected
+static const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const int TILE_BINS_COUNT = Game::Internal::BoardEngine::MAX_EXPONENT + 1;
+
+
+namespace Game {
+namespace Internal {
+
+namespace {
+
+struct SimulationFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrderMark;
+    std::uint32_t policy;
+    std::uint32_t depth;
+    std::uint64_t seed;
+    std::uint64_t firstGame;
+    std::uint64_t gamesCount;
+    double seconds;
+    std::uint32_t scoreBinWidth;
+    std::uint32_t scoreBinsCount;
+};
+
+static_assert(sizeof(SimulatedGame) == 3 * sizeof(std::uint32_t), "Game summaries are written as they are");
+
+} // namespace
+
+
+static bool validPolicy(std::uint32_t policy)
+{
+    return std::uint32_t(SimulationPolicy::Expectimax) >= policy;
+}
+
+
+bool SimulationShards::save(const std::string &fileName, const SimulationShard &shard)
+{
+    const auto &games = shard.statistics.games;
+    const auto tiles = shard.statistics.maxTiles();
+    const auto scores = scoreHistogram(shard.statistics);
+
+    SimulationFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SIMULATION_FILE_MAGIC, sizeof(header.magic));
+    header.version = SIMULATION_FILE_VERSION;
+    header.byteOrderMark = BYTE_ORDER_MARK;
+    header.policy = std::uint32_t(shard.policy);
+    header.depth = std::uint32_t(shard.depth);
+    header.seed = shard.seed;
+    header.firstGame = shard.firstGame;
+    header.gamesCount = games.size();
+    header.seconds = shard.statistics.seconds;
+    header.scoreBinWidth = SCORE_BIN_WIDTH;
+    header.scoreBinsCount = std::uint32_t(scores.size());
+
+    std::FILE *file = std::fopen(fileName.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = (1 == std::fwrite(&header, sizeof(header), 1, file));
+    ok = ok && (tiles.size() == std::fwrite(tiles.data(), sizeof(std::uint64_t), tiles.size(), file));
+    ok = ok && (scores.size() == std::fwrite(scores.data(), sizeof(std::uint64_t), scores.size(), file));
+    ok = ok && (games.size() == std::fwrite(games.data(), sizeof(SimulatedGame), games.size(), file));
+
+    return (0 == std::fclose(file)) && ok;
+}
+
+
+bool SimulationShards::load(const std::string &fileName, SimulationShard &shard)
+{
+    std::FILE *file = std::fopen(fileName.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    SimulationFileHeader header;
+    bool ok = (1 == std::fread(&header, sizeof(header), 1, file));
+
+    ok = ok && 0 == std::memcmp(header.magic, SIMULATION_FILE_MAGIC, sizeof(header.magic))
+            && SIMULATION_FILE_VERSION == header.version && BYTE_ORDER_MARK == header.byteOrderMark
+            && validPolicy(header.policy) && 0 < header.depth && SCORE_BIN_WIDTH == header.scoreBinWidth;
+
+    // The counts are checked against the file size before anything is allocated for them
+    if (ok) {
+        const std::uint64_t size = sizeof(header) + (TILE_BINS_COUNT + std::uint64_t(header.scoreBinsCount))
+                * sizeof(std::uint64_t) + header.gamesCount * sizeof(SimulatedGame);
+        ok = (0 == std::fseek(file, 0, SEEK_END)) && (std::uint64_t(std::ftell(file)) == size)
+                && (0 == std::fseek(file, long(sizeof(header)), SEEK_SET));
+    }
+
+    std::array<std::uint64_t, TILE_BINS_COUNT> tiles;
+    std::vector<std::uint64_t> scores;
+
+    if (ok) {
+        scores.resize(header.scoreBinsCount);
+        shard.statistics.games.resize(std::size_t(header.gamesCount));
+        ok = (tiles.size() == std::fread(tiles.data(), sizeof(std::uint64_t), tiles.size(), file))
+                && (scores.size() == std::fread(scores.data(), sizeof(std::uint64_t), scores.size(), file))
+                && (shard.statistics.games.size() == std::fread(shard.statistics.games.data(), sizeof(SimulatedGame),
+                                                                shard.statistics.games.size(), file));
+    }
+
+    std::fclose(file);
+
+    if (!ok) {
+        return false;
+    }
+
+    shard.policy = SimulationPolicy(header.policy);
+    shard.depth = int(header.depth);
+    shard.seed = header.seed;
+    shard.firstGame = header.firstGame;
+    shard.statistics.seconds = header.seconds;
+
+    // The histograms are there for readers which skip the games, so they have to tell the same
+    return tiles == shard.statistics.maxTiles() && scores == scoreHistogram(shard.statistics);
+}
+
+
+bool SimulationShards::merge(std::vector<SimulationShard> shards, SimulationShard &merged)
+{
+    if (shards.empty()) {
+        return false;
+    }
+
+    std::sort(shards.begin(), shards.end(), [](const SimulationShard &left, const SimulationShard &right) {
+        return left.firstGame < right.firstGame;
+    });
+
+    const SimulationShard &first = shards.front();
+
+    merged.policy = first.policy;
+    merged.depth = first.depth;
+    merged.seed = first.seed;
+    merged.firstGame = first.firstGame;
+    merged.statistics.games.clear();
+    merged.statistics.seconds = 0.0;
+
+    std::uint64_t nextGame = first.firstGame;
+
+    for (const SimulationShard &shard : shards) {
+        if (shard.policy != first.policy || shard.depth != first.depth || shard.seed != first.seed
+                || shard.firstGame != nextGame) {
+            return false;
+        }
+
+        const auto &games = shard.statistics.games;
+        merged.statistics.games.insert(merged.statistics.games.end(), games.cbegin(), games.cend());
+        merged.statistics.seconds = std::max(merged.statistics.seconds, shard.statistics.seconds);
+        nextGame += games.size();
+    }
+
+    return true;
+}
+
+
+std::vector<std::uint64_t> SimulationShards::scoreHistogram(const SimulationStatistics &statistics)
+{
+    std::vector<std::uint64_t> counts;
+
+    for (const SimulatedGame &game : statistics.games) {
+        const std::size_t bin = game.score / SCORE_BIN_WIDTH;
+        if (counts.size() <= bin) {
+            counts.resize(bin + 1, 0);
+        }
+        ++counts[bin];
+    }
+
+    return counts;
+}
+
+} // namespace Internal
+} // namespace Game
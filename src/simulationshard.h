@@ -0,0 +1,73 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef SIMULATIONSHARD_H
+#define SIMULATIONSHARD_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "boardengine.h"
+#include "simulator.h"
+
+
+namespace Game {
+namespace Internal {
+
+// The games [firstGame, firstGame + games) of one simulation run
+struct SimulationShard
+{
+    SimulationPolicy policy;
+    int depth;
+    std::uint64_t seed;
+    std::uint64_t firstGame;
+    SimulationStatistics statistics;
+};
+
+// Result files of the simulation shards. A file is a header, the games by max tile exponent,
+// the games by score bin and the summaries of the games, all in the native byte order.
+class SimulationShards final
+{
+public:
+    static const std::uint32_t SCORE_BIN_WIDTH = 1024;
+
+    static bool save(const std::string &fileName, const SimulationShard &shard);
+    // Fails on files of another version or byte order, and on histograms which don't match the games
+    static bool load(const std::string &fileName, SimulationShard &shard);
+
+    // The shards of one run in any order. Fails when they were played with other settings
+    // or their games don't join into one range. The shards are taken to have been played at the same
+    // time, so the seconds are the ones of the slowest shard.
+    static bool merge(std::vector<SimulationShard> shards, SimulationShard &merged);
+
+    // Games by score / SCORE_BIN_WIDTH, up to the bin of the best score
+    static std::vector<std::uint64_t> scoreHistogram(const SimulationStatistics &statistics);
+
+private:
+    SimulationShards() = delete;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // SIMULATIONSHARD_H
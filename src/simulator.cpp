@@ -0,0 +1,277 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "bitoperations.h"
+#include "expectimax.h"
+#include "randomgenerator.h"
+#include "simulator.h"
+#include "threadpool.h"
+#include "transpositiontable.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+// Every game searches with its own table, small enough for a game per thread
+static const std::size_t TRANSPOSITION_TABLE_ENTRIES = 1 << 16;
+
+
+namespace Game {
+namespace Internal {
+
+static Direction randomMove(Directions legalMoves, RandomGenerator &random)
+{
+    int rank = int(random.bounded(std::uint32_t(popCount(legalMoves))));
+
+    for (int move = 0; move < 4; ++move) {
+        if (0 != (legalMoves & BoardEngine::directionBit(Direction(move))) && 0 == rank--) {
+            return Direction(move);
+        }
+    }
+
+    assert(false);
+    return Direction::Left;
+}
+
+
+static Direction greedyMove(Board board, Directions legalMoves)
+{
+    Direction bestMove = Direction::Left;
+    int bestScore = -1;
+
+    for (int move = 0; move < 4; ++move) {
+        if (0 == (legalMoves & BoardEngine::directionBit(Direction(move)))) {
+            continue;
+        }
+
+        const int score = BoardEngine::move(board, Direction(move)).score;
+        if (bestScore < score) {
+            bestScore = score;
+            bestMove = Direction(move);
+        }
+    }
+
+    return bestMove;
+}
+
+
+std::uint64_t SimulationStatistics::moves() const
+{
+    std::uint64_t moves = 0;
+
+    for (const SimulatedGame &game : games) {
+        moves += game.moves;
+    }
+
+    return moves;
+}
+
+
+double SimulationStatistics::gamesPerSecond() const
+{
+    return (0.0 < seconds) ? games.size() / seconds : 0.0;
+}
+
+
+double SimulationStatistics::movesPerSecond() const
+{
+    return (0.0 < seconds) ? moves() / seconds : 0.0;
+}
+
+
+double SimulationStatistics::meanScore() const
+{
+    if (games.empty()) {
+        return 0.0;
+    }
+
+    double score = 0.0;
+    for (const SimulatedGame &game : games) {
+        score += game.score;
+    }
+
+    return score / games.size();
+}
+
+
+double SimulationStatistics::winRate() const
+{
+    if (games.empty()) {
+        return 0.0;
+    }
+
+    const auto wins = std::count_if(games.cbegin(), games.cend(), [](const SimulatedGame &game) {
+        return Simulator::WIN_EXPONENT <= int(game.maxExponent);
+    });
+
+    return double(wins) / games.size();
+}
+
+
+std::uint32_t SimulationStatistics::scorePercentile(double percentile) const
+{
+    assert(0.0 <= percentile && percentile <= 100.0);
+
+    if (games.empty()) {
+        return 0;
+    }
+
+    std::vector<std::uint32_t> scores;
+    scores.reserve(games.size());
+    for (const SimulatedGame &game : games) {
+        scores.push_back(game.score);
+    }
+
+    const std::size_t rank = std::size_t(std::ceil(percentile / 100.0 * scores.size()));
+    const std::size_t index = std::max<std::size_t>(rank, 1) - 1;
+    std::nth_element(scores.begin(), scores.begin() + std::ptrdiff_t(index), scores.end());
+
+    return scores[index];
+}
+
+
+std::array<std::uint64_t, BoardEngine::MAX_EXPONENT + 1> SimulationStatistics::maxTiles() const
+{
+    std::array<std::uint64_t, BoardEngine::MAX_EXPONENT + 1> counts;
+    counts.fill(0);
+
+    for (const SimulatedGame &game : games) {
+        ++counts[std::min<std::size_t>(game.maxExponent, BoardEngine::MAX_EXPONENT)];
+    }
+
+    return counts;
+}
+
+
+Simulator::Simulator(ThreadPool *pool, std::uint64_t seed) :
+    m_pool(pool),
+    m_seed(seed),
+    m_policy(SimulationPolicy::Greedy),
+    m_depth(DEFAULT_DEPTH)
+{
+}
+
+
+SimulationPolicy Simulator::policy() const
+{
+    return m_policy;
+}
+
+
+void Simulator::setPolicy(SimulationPolicy policy)
+{
+    m_policy = policy;
+}
+
+
+int Simulator::depth() const
+{
+    return m_depth;
+}
+
+
+void Simulator::setDepth(int depth)
+{
+    assert(0 < depth);
+    m_depth = depth;
+}
+
+
+SimulationStatistics Simulator::run(int games, std::uint64_t firstGame) const
+{
+    assert(0 <= games);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    SimulationStatistics statistics;
+    statistics.games.resize(static_cast<std::size_t>(games));
+
+    const auto runGame = [&](int index) {
+        statistics.games[std::size_t(index)] = playGame(firstGame + std::uint64_t(index));
+    };
+
+    if (m_pool) {
+        m_pool->parallelFor(games, runGame);
+    } else {
+        for (int index = 0; index < games; ++index) {
+            runGame(index);
+        }
+    }
+
+    statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return statistics;
+}
+
+
+SimulatedGame Simulator::playGame(std::uint64_t game) const
+{
+    RandomGenerator random(m_seed, game);
+
+    // The games are the parallel tasks, so every search runs on the thread of its game
+    std::unique_ptr<TranspositionTable> table;
+    std::unique_ptr<Expectimax> search;
+
+    if (SimulationPolicy::Expectimax == m_policy) {
+        table = std::make_unique<TranspositionTable>(TRANSPOSITION_TABLE_ENTRIES);
+        search = std::make_unique<Expectimax>();
+        search->setDepth(m_depth);
+        search->setHeuristic(&m_heuristic);
+        search->setTranspositionTable(table.get());
+    }
+
+    SimulatedGame result = { 0, 0, 0 };
+    Board board = BoardEngine::spawnRandomTile(BoardEngine::spawnRandomTile(0, random), random);
+
+    for (Directions legalMoves = BoardEngine::legalMoves(board); 0 != legalMoves;
+         legalMoves = BoardEngine::legalMoves(board)) {
+        Direction move = Direction::Left;
+
+        switch (m_policy) {
+        case SimulationPolicy::Random:
+            move = randomMove(legalMoves, random);
+            break;
+        case SimulationPolicy::Greedy:
+            move = greedyMove(board, legalMoves);
+            break;
+        case SimulationPolicy::Expectimax:
+            move = search->search(board).bestMove;
+            break;
+        }
+
+        const MoveResult moved = BoardEngine::move(board, move);
+        assert(moved.board != board);
+
+        board = BoardEngine::spawnRandomTile(moved.board, random);
+        result.score += std::uint32_t(moved.score);
+        ++result.moves;
+    }
+
+    result.maxExponent = std::uint32_t(BoardEngine::maxExponent(board));
+
+    return result;
+}
+
+} // namespace Internal
+} // namespace Game
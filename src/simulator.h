@@ -0,0 +1,108 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "boardengine.h"
+#include "heuristic.h"
+
+
+namespace Game {
+namespace Internal {
+
+class RandomGenerator;
+class ThreadPool;
+
+enum class SimulationPolicy
+{
+    // A uniformly random legal move
+    Random,
+    // The move with the most merge score, the first one of the best when they tie
+    Greedy,
+    // Expectimax to the given depth over the table heuristic
+    Expectimax
+};
+
+struct SimulatedGame
+{
+    std::uint32_t score;
+    std::uint32_t moves;
+    std::uint32_t maxExponent;
+};
+
+struct SimulationStatistics
+{
+    // In the order of the games, which makes them independent of the threads
+    std::vector<SimulatedGame> games;
+    double seconds;
+
+    std::uint64_t moves() const;
+    double gamesPerSecond() const;
+    double movesPerSecond() const;
+    double meanScore() const;
+    double winRate() const;
+    // Nearest rank percentile of the scores
+    std::uint32_t scorePercentile(double percentile) const;
+    // Games by their max tile exponent
+    std::array<std::uint64_t, BoardEngine::MAX_EXPONENT + 1> maxTiles() const;
+};
+
+// Plays whole games of the packed board rules without Qt. Every game is a pool task with its own
+// (seed, game index) random stream, so the games don't depend on the threads which play them.
+class Simulator final
+{
+public:
+    static const int WIN_EXPONENT = 11;
+    static const int DEFAULT_DEPTH = 2;
+
+    explicit Simulator(ThreadPool *pool = nullptr, std::uint64_t seed = 0);
+
+    SimulationPolicy policy() const;
+    void setPolicy(SimulationPolicy policy);
+
+    int depth() const;
+    void setDepth(int depth);
+
+    // Plays the games [firstGame, firstGame + games)
+    SimulationStatistics run(int games, std::uint64_t firstGame = 0) const;
+    SimulatedGame playGame(std::uint64_t game) const;
+
+private:
+    Simulator(const Simulator &) = delete;
+    Simulator &operator=(const Simulator &) = delete;
+
+    ThreadPool *const m_pool;
+    const std::uint64_t m_seed;
+    Heuristic m_heuristic;
+    SimulationPolicy m_policy;
+    int m_depth;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // SIMULATOR_H
@@ -0,0 +1,216 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "bitoperations.h"
+#include "smallboardengine.h"
+
+#include <cassert>
+
+static const int CELL_BITS = 4;
+static const int ROW_BITS = 16;
+
+
+namespace Game {
+namespace Internal {
+
+static std::uint64_t lineMask(int columns)
+{
+    return (std::uint64_t(1) << (CELL_BITS * columns)) - 1;
+}
+
+
+static std::uint64_t boardCells(int rows, int columns)
+{
+    std::uint64_t cells = 0;
+
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            cells |= std::uint64_t(1) << (CELL_BITS * (row * BoardEngine::COLUMNS + column));
+        }
+    }
+
+    return cells;
+}
+
+
+SmallBoardEngine::SmallBoardEngine(int rows, int columns) :
+    m_rows(rows),
+    m_columns(columns),
+    m_rowsShift(ROW_BITS * (BoardEngine::ROWS - rows)),
+    m_columnsShift(CELL_BITS * (BoardEngine::COLUMNS - columns)),
+    m_cells(boardCells(rows, columns))
+{
+    assert(0 < rows && rows <= BoardEngine::ROWS);
+    assert(0 < columns && columns <= BoardEngine::COLUMNS);
+}
+
+
+int SmallBoardEngine::rows() const
+{
+    return m_rows;
+}
+
+
+int SmallBoardEngine::columns() const
+{
+    return m_columns;
+}
+
+
+int SmallBoardEngine::cells() const
+{
+    return m_rows * m_columns;
+}
+
+
+int SmallBoardEngine::symmetries() const
+{
+    return (m_rows == m_columns) ? BoardEngine::SYMMETRIES : BoardEngine::SYMMETRIES / 2;
+}
+
+
+int SmallBoardEngine::cell(int row, int column) const
+{
+    assert(0 <= row && row < m_rows);
+    assert(0 <= column && column < m_columns);
+
+    return row * BoardEngine::COLUMNS + column;
+}
+
+
+std::uint64_t SmallBoardEngine::emptyCells(Board board) const
+{
+    return BoardEngine::emptyCells(board) & m_cells;
+}
+
+
+int SmallBoardEngine::emptyCellsCount(Board board) const
+{
+    return popCount(emptyCells(board));
+}
+
+
+Board SmallBoardEngine::spawnTile(Board board, int emptyCellRank, int exponent) const
+{
+    assert(0 <= emptyCellRank && emptyCellRank < emptyCellsCount(board));
+    assert(0 < exponent && exponent <= BoardEngine::MAX_EXPONENT);
+
+    const int shift = selectBit(emptyCells(board), emptyCellRank);
+    return board | (Board(exponent) << shift);
+}
+
+
+// Right and down moves run on the board shifted to the right and bottom walls
+Directions SmallBoardEngine::legalMoves(Board board) const
+{
+    const Directions leftUp = BoardEngine::directionBit(Direction::Left) | BoardEngine::directionBit(Direction::Up);
+
+    return (BoardEngine::legalMoves(board) & leftUp) |
+           (BoardEngine::legalMoves(board << m_columnsShift) & BoardEngine::directionBit(Direction::Right)) |
+           (BoardEngine::legalMoves(board << m_rowsShift) & BoardEngine::directionBit(Direction::Down));
+}
+
+
+MoveResult SmallBoardEngine::move(Board board, Direction direction) const
+{
+    int shift = 0;
+
+    switch (direction) {
+    case Direction::Left:
+    case Direction::Up:
+        break;
+    case Direction::Right:
+        shift = m_columnsShift;
+        break;
+    case Direction::Down:
+        shift = m_rowsShift;
+        break;
+    }
+
+    MoveResult result = BoardEngine::move(board << shift, direction);
+    result.board >>= shift;
+    return result;
+}
+
+
+Board SmallBoardEngine::symmetry(Board board, int symmetry) const
+{
+    assert(0 <= symmetry && symmetry < symmetries());
+
+    if (0 != (symmetry & 4)) {
+        board = BoardEngine::transpose(board);
+    }
+    if (0 != (symmetry & 1)) {
+        board = BoardEngine::mirrorRows(board) >> m_columnsShift;
+    }
+    if (0 != (symmetry & 2)) {
+        board = BoardEngine::mirrorColumns(board) >> m_rowsShift;
+    }
+
+    return board;
+}
+
+
+Board SmallBoardEngine::canonical(Board board, int &symmetry) const
+{
+    Board result = board;
+    symmetry = 0;
+
+    for (int i = 1; i < symmetries(); ++i) {
+        const Board candidate = this->symmetry(board, i);
+        if (candidate < result) {
+            result = candidate;
+            symmetry = i;
+        }
+    }
+
+    return result;
+}
+
+
+std::uint64_t SmallBoardEngine::key(Board board) const
+{
+    std::uint64_t key = 0;
+
+    for (int row = 0; row < m_rows; ++row) {
+        const std::uint64_t line = (board >> (ROW_BITS * row)) & lineMask(m_columns);
+        key |= line << (CELL_BITS * m_columns * row);
+    }
+
+    return key;
+}
+
+
+Board SmallBoardEngine::board(std::uint64_t key) const
+{
+    Board board = 0;
+
+    for (int row = 0; row < m_rows; ++row) {
+        const std::uint64_t line = (key >> (CELL_BITS * m_columns * row)) & lineMask(m_columns);
+        board |= line << (ROW_BITS * row);
+    }
+
+    return board;
+}
+
+} // namespace Internal
+} // namespace Game
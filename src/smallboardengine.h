@@ -0,0 +1,77 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef SMALLBOARDENGINE_H
+#define SMALLBOARDENGINE_H
+
+#include <cstdint>
+
+#include "boardengine.h"
+
+
+namespace Game {
+namespace Internal {
+
+// Rules of boards up to 4x4. The board sits in the top left corner of a packed 4x4 board
+// and the other cells stay empty, so the row tables of the board engine play it.
+class SmallBoardEngine final
+{
+public:
+    SmallBoardEngine(int rows, int columns);
+
+    int rows() const;
+    int columns() const;
+    int cells() const;
+    // Rectangles have the 4 mirrorings, squares the transposed ones too
+    int symmetries() const;
+
+    // Index of the cell in the packed 4x4 board
+    int cell(int row, int column) const;
+
+    // The lowest bit of every empty cell nibble of the board is set
+    std::uint64_t emptyCells(Board board) const;
+    int emptyCellsCount(Board board) const;
+    Board spawnTile(Board board, int emptyCellRank, int exponent) const;
+
+    Directions legalMoves(Board board) const;
+    MoveResult move(Board board, Direction direction) const;
+
+    // Symmetries are numbered like the ones of the board engine
+    Board symmetry(Board board, int symmetry) const;
+    Board canonical(Board board, int &symmetry) const;
+
+    // The cell nibbles without the gaps of the 4x4 board, the order of boards is kept
+    std::uint64_t key(Board board) const;
+    Board board(std::uint64_t key) const;
+
+private:
+    const int m_rows;
+    const int m_columns;
+    const int m_rowsShift;
+    const int m_columnsShift;
+    const std::uint64_t m_cells;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // SMALLBOARDENGINE_H
@@ -125,10 +125,10 @@ StorageState Storage::state() const
 }
 
 
-void Storage::createGame(int rows, int columns)
+void Storage::createGame(int rows, int columns, qint64 seed)
 {
     QMetaObject::invokeMethod(d->m_worker.get(), "createGame", Qt::QueuedConnection,
-                              Q_ARG(int, rows), Q_ARG(int, columns));
+                              Q_ARG(int, rows), Q_ARG(int, columns), Q_ARG(qint64, seed));
 }
 
 
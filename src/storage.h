@@ -70,7 +70,7 @@ signals:
     void undoTurnError();
 
 public slots:
-    void createGame(int rows, int columns);
+    void createGame(int rows, int columns, qint64 seed);
     void restoreGame();
     void saveTurn(const QVariantMap &turn);
     void undoTurn(int turnId);
@@ -35,6 +35,7 @@ const char *const MOVE_DIRECTION_KEY = "moveDirection";
 const char *const PARENT_TURN_ID_KEY = "parentTurnId";
 const char *const ROWS_KEY = "rows";
 const char *const SCORE_KEY = "score";
+const char *const SEED_KEY = "seed";
 const char *const TILE_CELL_KEY = "tileCell";
 const char *const TILE_ID_KEY = "tileId";
 const char *const TILE_VALUE_KEY = "tileValue";
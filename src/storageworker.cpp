@@ -53,12 +53,16 @@ static const char *const PARENT_TURN_ID_COLUMN_NAME = "parent_turn_id";
 static const char *const ROWS_COLUMN_NAME = "rows";
 static const char *const MOVE_DIRECTION_COLUMN_NAME = "move_direction";
 static const char *const SCORE_COLUMN_NAME = "score";
+static const char *const SEED_COLUMN_NAME = "seed";
 static const char *const TILE_CELL_COLUMN_NAME = "cell_index";
 static const char *const TILE_ID_COLUMN_NAME = "tile_id";
 static const char *const TILE_VALUE_COLUMN_NAME = "tile_value";
 static const char *const TILE_STATE_COLUMN_NAME = "tile_state";
 static const char *const TURN_ID_COLUMN_NAME = "turn_id";
 
+static const char *const TILES_TABLE_NAME = "tiles";
+static const int SAVED_TILE_COLUMNS_COUNT = 4;
+
 static const char *const GAME_STATE_INIT_NAME = "I";
 static const char *const GAME_STATE_PLAY_NAME = "P";
 static const char *const GAME_STATE_WIN_NAME = "W";
@@ -91,7 +95,10 @@ namespace Game {
 namespace Internal {
 
 StorageWorker::StorageWorker() :
-    QObject(nullptr)
+    QObject(nullptr),
+    m_saveTilesQuery(QLatin1Literal(TILES_TABLE_NAME),
+                     QStringList() << QLatin1Literal(TURN_ID_COLUMN_NAME) << QLatin1Literal(TILE_ID_COLUMN_NAME)
+                                   << QLatin1Literal(TILE_VALUE_COLUMN_NAME) << QLatin1Literal(TILE_CELL_COLUMN_NAME))
 {
 }
 
@@ -137,6 +144,8 @@ void StorageWorker::openDatabase()
         return;
     }
 
+    m_saveTilesQuery.setDatabase(m_db);
+
     const int version = databaseVersion();
 
     if (WRONG_DATABASE_VERSION == version) {
@@ -148,6 +157,9 @@ void StorageWorker::openDatabase()
 
     switch (version) {
     case 1:
+        ready = upgradeDatabase();
+        break;
+    case 2:
         ready = true;
         break;
     default:
@@ -169,6 +181,7 @@ void StorageWorker::openDatabase()
 void StorageWorker::closeDatabase()
 {
     if (m_db.isOpen()) {
+        m_saveTilesQuery.setDatabase(QSqlDatabase());
         vacuum();
         m_db.close();
         qDebug() << "Database closed";
@@ -176,7 +189,7 @@ void StorageWorker::closeDatabase()
 }
 
 
-void StorageWorker::createGame(int rows, int columns)
+void StorageWorker::createGame(int rows, int columns, qint64 seed)
 {
     QMutexLocker locker(&m_lock);
     const bool transactional = startTransaction();
@@ -187,7 +200,7 @@ void StorageWorker::createGame(int rows, int columns)
     }
 
     QVariant gameId;
-    if (!createGame(rows, columns, gameId)) {
+    if (!createGame(rows, columns, seed, gameId)) {
         handleCreateGameError();
         return;
     }
@@ -206,6 +219,7 @@ void StorageWorker::createGame(int rows, int columns)
     game.insert(QLatin1Literal(GAME_ID_KEY), gameId);
     game.insert(QLatin1Literal(ROWS_KEY), rows);
     game.insert(QLatin1Literal(COLUMNS_KEY), columns);
+    game.insert(QLatin1Literal(SEED_KEY), seed);
 
     emit gameCreated(game);
 }
@@ -232,6 +246,12 @@ void StorageWorker::saveTurn(const QVariantMap &turn)
 
     const bool transactional = startTransaction();
 
+    // Continue saves the spawn of the winning turn under its id, so a stored turn is rewritten
+    if (!removeTurn(turnId.toInt())) {
+        handleSaveTurnError();
+        return;
+    }
+
     QSqlQuery sqlQuery(m_db);
 
     const QString &query = QLatin1Literal("INSERT INTO turns (turn_id, parent_turn_id, move_direction, score, best_score) "
@@ -289,9 +309,25 @@ void StorageWorker::saveTurn(const QVariantMap &turn)
 
 void StorageWorker::undoTurn(int turnId)
 {
-    Q_UNUSED(turnId)
-    qDebug() << "Coming soon!";
-    emit undoTurnError();
+    QMutexLocker locker(&m_lock);
+    const bool transactional = startTransaction();
+
+    if (!removeTurn(turnId)) {
+        handleUndoTurnError();
+        return;
+    }
+
+    if (transactional && !commitTransaction()) {
+        handleUndoTurnError();
+        return;
+    }
+
+    qDebug().nospace() << "U | " << turnId;
+
+    QVariantMap turn;
+    turn.insert(QLatin1Literal(TURN_ID_KEY), turnId);
+
+    emit turnUndid(turn);
 }
 
 
@@ -302,7 +338,7 @@ void StorageWorker::restoreGame()
 
     QSqlQuery sqlQuery(m_db);
 
-    const QString &query = QLatin1Literal("SELECT games.game_id, games.rows, games.columns, games.game_state, "
+    const QString &query = QLatin1Literal("SELECT games.game_id, games.rows, games.columns, games.game_state, games.seed, "
                                                  "turns.turn_id, turns.parent_turn_id, turns.score, turns.best_score "
                                           "FROM games, turns "
                                           "ORDER BY games.game_id DESC, turns.turn_id DESC LIMIT 1");
@@ -333,6 +369,7 @@ void StorageWorker::restoreGame()
     Q_ASSERT_X(sqlQuery.record().contains(QLatin1Literal(GAME_STATE_COLUMN_NAME)), "Restore game", "Game state column not found");
     Q_ASSERT_X(sqlQuery.record().contains(QLatin1Literal(SCORE_COLUMN_NAME)), "Restore game", "Score column not found");
     Q_ASSERT_X(sqlQuery.record().contains(QLatin1Literal(BEST_SCORE_COLUMN_NAME)), "Restore game", "Best score column not found");
+    Q_ASSERT_X(sqlQuery.record().contains(QLatin1Literal(SEED_COLUMN_NAME)), "Restore game", "Seed column not found");
 
     const QVariant &gameId = sqlQuery.value(QLatin1Literal(GAME_ID_COLUMN_NAME));
     const QVariant &rows = sqlQuery.value(QLatin1Literal(ROWS_COLUMN_NAME));
@@ -342,6 +379,7 @@ void StorageWorker::restoreGame()
     const QVariant &gameState = sqlQuery.value(QLatin1Literal(GAME_STATE_COLUMN_NAME));
     const QVariant &score = sqlQuery.value(QLatin1Literal(SCORE_COLUMN_NAME));
     const QVariant &bestScore = sqlQuery.value(QLatin1Literal(BEST_SCORE_COLUMN_NAME));
+    const QVariant &seed = sqlQuery.value(QLatin1Literal(SEED_COLUMN_NAME));
 
     bool ok = false;
     const QVariant &maxTurnId = getMaxTurnId(ok);
@@ -379,6 +417,7 @@ void StorageWorker::restoreGame()
     game.insert(QLatin1Literal(GAME_STATE_KEY), gameState);
     game.insert(QLatin1Literal(SCORE_KEY), score);
     game.insert(QLatin1Literal(BEST_SCORE_KEY), bestScore);
+    game.insert(QLatin1Literal(SEED_KEY), seed);
     game.insert(QLatin1Literal(TILES_KEY), tiles);
 
     emit gameRestored(game);
@@ -434,6 +473,25 @@ bool StorageWorker::createDatabase()
 }
 
 
+bool StorageWorker::upgradeDatabase()
+{
+    Q_ASSERT(m_db.isValid());
+
+    const bool transactional = startTransaction();
+
+    if (!executeFileQueries(QLatin1Literal("://sql/upgrade.sql"))) {
+        rollbackTransaction();
+        return false;
+    }
+
+    if (transactional && !commitTransaction()) {
+        return false;
+    }
+
+    return true;
+}
+
+
 bool StorageWorker::executeQuery(const QString &query, QString &error)
 {
     QSqlQuery sqlQuery(m_db);
@@ -476,9 +534,9 @@ bool StorageWorker::finishGame()
     QSqlQuery sqlQuery(m_db);
 
     const QString &query = QLatin1Literal("REPLACE INTO games (game_id, start_time, finish_time, rows, "
-                                                              "columns, score, best_score, game_state) "
+                                                              "columns, score, best_score, game_state, seed) "
                                           "SELECT games.game_id, games.start_time, turns.turn_time, games.rows, "
-                                                 "games.columns, turns.score, turns.best_score, games.game_state "
+                                                 "games.columns, turns.score, turns.best_score, games.game_state, games.seed "
                                           "FROM games, turns "
                                           "ORDER BY games.game_id DESC, turns.turn_id DESC LIMIT 1");
 
@@ -492,11 +550,11 @@ bool StorageWorker::finishGame()
 }
 
 
-bool StorageWorker::createGame(int rows, int columns, QVariant &gameId)
+bool StorageWorker::createGame(int rows, int columns, qint64 seed, QVariant &gameId)
 {
     QSqlQuery sqlQuery(m_db);
 
-    const QString &query = QLatin1Literal("INSERT INTO games (rows, columns) VALUES (?, ?)");
+    const QString &query = QLatin1Literal("INSERT INTO games (rows, columns, seed) VALUES (?, ?, ?)");
 
     if (!sqlQuery.prepare(query)) {
         qWarning() << "Failed to prepare the create game query:" << qPrintable(sqlQuery.lastError().text());
@@ -505,6 +563,7 @@ bool StorageWorker::createGame(int rows, int columns, QVariant &gameId)
 
     sqlQuery.addBindValue(rows);
     sqlQuery.addBindValue(columns);
+    sqlQuery.addBindValue(seed);
 
     if (!sqlQuery.exec()) {
         qWarning() << "Failed to execute the create game query:" << qPrintable(sqlQuery.lastError().text());
@@ -543,27 +602,20 @@ bool StorageWorker::saveTiles(const QVariant &turnId, const QVariantList &tiles)
 {
     Q_ASSERT_X(!tiles.isEmpty(), "Save tiles", "There is no tiles for save");
 
-    QSqlQuery sqlQuery(m_db);
-
-    const QString &query = QLatin1Literal("INSERT INTO tiles (turn_id, tile_id, tile_value, cell_index) "
-                                          "VALUES (?, ?, ?, ?)");
-
-    if (!sqlQuery.prepare(query)) {
-        qWarning() << "Failed to prepare the save tiles query:" << qPrintable(sqlQuery.lastError().text());
-        return false;
-    }
+    QVariantList values;
+    values.reserve(tiles.size() * SAVED_TILE_COLUMNS_COUNT);
 
     for (const QVariant &var : tiles) {
         const QVariantMap &tile = var.toMap();
-        sqlQuery.addBindValue(turnId);
-        sqlQuery.addBindValue(tile.value(QLatin1Literal(TILE_ID_KEY)));
-        sqlQuery.addBindValue(tile.value(QLatin1Literal(TILE_VALUE_KEY)));
-        sqlQuery.addBindValue(tile.value(QLatin1Literal(TILE_CELL_KEY)));
+        values.append(turnId);
+        values.append(tile.value(QLatin1Literal(TILE_ID_KEY)));
+        values.append(tile.value(QLatin1Literal(TILE_VALUE_KEY)));
+        values.append(tile.value(QLatin1Literal(TILE_CELL_KEY)));
+    }
 
-        if (!sqlQuery.exec()) {
-            qWarning() << "Failed to execute the save tiles query:" << qPrintable(sqlQuery.lastError().text());
-            return false;
-        }
+    if (!m_saveTilesQuery.exec(values)) {
+        qWarning() << "Failed to execute the save tiles query:" << qPrintable(m_saveTilesQuery.lastError().text());
+        return false;
     }
 
     return true;
@@ -650,6 +702,33 @@ QVariant StorageWorker::getMaxTurnId(bool &ok) const
 }
 
 
+bool StorageWorker::removeTurn(int turnId)
+{
+    QSqlQuery sqlQuery(m_db);
+
+    const char *const queries[] = {
+        "DELETE FROM tiles WHERE turn_id = ?",
+        "DELETE FROM turns WHERE turn_id = ?"
+    };
+
+    for (const char *const query : queries) {
+        if (!sqlQuery.prepare(QLatin1String(query))) {
+            qWarning() << "Failed to prepare the remove turn query:" << qPrintable(sqlQuery.lastError().text());
+            return false;
+        }
+
+        sqlQuery.addBindValue(turnId);
+
+        if (!sqlQuery.exec()) {
+            qWarning() << "Failed to execute the remove turn query:" << qPrintable(sqlQuery.lastError().text());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
 void StorageWorker::removeTurns()
 {
     QString error;
@@ -27,6 +27,7 @@
 #include <QObject>
 #include <QSqlDatabase>
 
+#include "batchinsertquery.h"
 #include "gamestate.h"
 #include "movedirection.h"
 
@@ -59,7 +60,7 @@ signals:
 public slots:
     void openDatabase();
     void closeDatabase();
-    void createGame(int rows, int columns);
+    void createGame(int rows, int columns, qint64 seed);
     void restoreGame();
     void saveTurn(const QVariantMap &turn);
     void undoTurn(int turnId);
@@ -69,17 +70,19 @@ private:
 
     int databaseVersion();
     bool createDatabase();
+    bool upgradeDatabase();
     bool executeQuery(const QString &query, QString &error);
     bool executeFileQueries(const QString &fileName);
 
     bool finishGame();
-    bool createGame(int rows, int columns, QVariant &gameId);
+    bool createGame(int rows, int columns, qint64 seed, QVariant &gameId);
 
     bool saveGameState(const QVariant &gameId, GameState state);
     bool saveTiles(const QVariant &turnId, const QVariantList &tiles);
     QVariantList restoreTiles(const QVariant &turnId, bool &ok);
     QVariant getMaxTurnId(bool &ok) const;
 
+    bool removeTurn(int turnId);
     void removeTurns();
     void removeTiles();
     void vacuum();
@@ -105,6 +108,7 @@ private:
     bool rollbackTransaction();
 
     QSqlDatabase m_db;
+    BatchInsertQuery m_saveTilesQuery;
     QMutex m_lock;
 };
 
@@ -0,0 +1,383 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "smallboardengine.h"
+#include "tablebase.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+static const char TABLEBASE_FILE_MAGIC[8] = { '2', '0', '4', '8', 'T', 'B', 'L', '\0' };
+static const std::uint32_t TABLEBASE_FILE_VERSION = 1;
+// Values are written in the native order, a file from a machine of the other endianness is rejected
+static const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const std::size_t SECTION_ALIGNMENT = 8;
+
+static const int CELL_BITS = 4;
+static const std::uint64_t CELL_MASK = 0xF;
+static const int MOVE_BITS = 2;
+static const int MOVES_PER_BYTE = 4;
+
+
+namespace Game {
+namespace Internal {
+
+namespace {
+
+struct TablebaseFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrderMark;
+    std::uint32_t rows;
+    std::uint32_t columns;
+    std::uint32_t keyBytes;
+    std::uint32_t layersCount;
+    std::uint64_t statesCount;
+    double startScore;
+};
+
+} // namespace
+
+
+// The layers are followed by one more, whose first state is the states count
+struct Tablebase::Layer
+{
+    std::uint32_t tileSum;
+    std::uint32_t reserved;
+    std::uint64_t first;
+};
+
+
+static std::size_t aligned(std::size_t size)
+{
+    return (size + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+
+// Keys are stored in the fewest bytes the cells fit in, least significant byte first
+static int keyBytes(int cells)
+{
+    return (cells * CELL_BITS + 7) / 8;
+}
+
+
+static std::uint64_t readKey(const unsigned char *keys, int keyBytes, std::uint64_t index)
+{
+    const unsigned char *bytes = keys + index * std::uint64_t(keyBytes);
+    std::uint64_t key = 0;
+
+    for (int i = keyBytes - 1; 0 <= i; --i) {
+        key = (key << 8) | bytes[i];
+    }
+
+    return key;
+}
+
+
+static void writeKey(unsigned char *bytes, int keyBytes, std::uint64_t key)
+{
+    for (int i = 0; i < keyBytes; ++i) {
+        bytes[i] = static_cast<unsigned char>(key >> (8 * i));
+    }
+}
+
+
+Tablebase::Tablebase() :
+    m_layers(nullptr),
+    m_layersCount(0),
+    m_keys(nullptr),
+    m_values(nullptr),
+    m_moves(nullptr),
+    m_statesCount(0),
+    m_keyBytes(0),
+    m_startScore(0.0)
+{
+}
+
+
+Tablebase::~Tablebase()
+{
+}
+
+
+bool Tablebase::attach(const void *data, std::size_t size)
+{
+    detach();
+
+    TablebaseFileHeader header;
+    if (!data || size < sizeof(header)) {
+        return false;
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+
+    if (0 != std::memcmp(header.magic, TABLEBASE_FILE_MAGIC, sizeof(header.magic)) ||
+            TABLEBASE_FILE_VERSION != header.version || BYTE_ORDER_MARK != header.byteOrderMark) {
+        return false;
+    }
+
+    if (header.rows < 1 || BoardEngine::ROWS < header.rows || header.columns < 1 || BoardEngine::COLUMNS < header.columns) {
+        return false;
+    }
+
+    const int cells = int(header.rows * header.columns);
+    if (keyBytes(cells) != int(header.keyBytes)) {
+        return false;
+    }
+
+    // Every state takes at least a key byte, which also keeps the offsets below from overflowing
+    if (size < header.statesCount || size / sizeof(Layer) < header.layersCount) {
+        return false;
+    }
+
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    const std::size_t layersOffset = sizeof(header);
+    const std::size_t keysOffset = layersOffset + (std::size_t(header.layersCount) + 1) * sizeof(Layer);
+    const std::size_t valuesOffset = keysOffset + aligned(std::size_t(header.statesCount) * header.keyBytes);
+    const std::size_t movesOffset = valuesOffset + aligned(std::size_t(header.statesCount) * sizeof(float));
+    const std::size_t movesSize = std::size_t((header.statesCount + MOVES_PER_BYTE - 1) / MOVES_PER_BYTE);
+
+    if (size != movesOffset + movesSize) {
+        return false;
+    }
+
+    // The lookups search the layers by tile sum and trust their state ranges, so a corrupt table is refused
+    const Layer *layers = reinterpret_cast<const Layer*>(bytes + layersOffset);
+    if (0 != layers[0].first || header.statesCount != layers[header.layersCount].first) {
+        return false;
+    }
+
+    for (std::uint32_t layer = 0; layer < header.layersCount; ++layer) {
+        if (layers[layer + 1].first < layers[layer].first ||
+                (0 < layer && layers[layer].tileSum <= layers[layer - 1].tileSum)) {
+            return false;
+        }
+    }
+
+    m_engine = std::make_unique<SmallBoardEngine>(int(header.rows), int(header.columns));
+    m_layers = layers;
+    m_layersCount = header.layersCount;
+    m_keys = bytes + keysOffset;
+    m_values = reinterpret_cast<const float*>(bytes + valuesOffset);
+    m_moves = bytes + movesOffset;
+    m_statesCount = header.statesCount;
+    m_keyBytes = int(header.keyBytes);
+    m_startScore = header.startScore;
+
+    return true;
+}
+
+
+void Tablebase::detach()
+{
+    m_engine.reset();
+    m_layers = nullptr;
+    m_layersCount = 0;
+    m_keys = nullptr;
+    m_values = nullptr;
+    m_moves = nullptr;
+    m_statesCount = 0;
+    m_keyBytes = 0;
+    m_startScore = 0.0;
+}
+
+
+bool Tablebase::isAttached() const
+{
+    return nullptr != m_engine;
+}
+
+
+int Tablebase::rows() const
+{
+    return m_engine ? m_engine->rows() : 0;
+}
+
+
+int Tablebase::columns() const
+{
+    return m_engine ? m_engine->columns() : 0;
+}
+
+
+std::uint64_t Tablebase::statesCount() const
+{
+    return m_statesCount;
+}
+
+
+double Tablebase::startScore() const
+{
+    return m_startScore;
+}
+
+
+bool Tablebase::lookup(Board board, TablebaseEntry &entry) const
+{
+    if (!m_engine) {
+        return false;
+    }
+
+    int symmetry = 0;
+    const Board canonical = m_engine->canonical(board, symmetry);
+
+    const std::uint32_t sum = tileSum(canonical);
+    const Layer *layersEnd = m_layers + m_layersCount;
+    const Layer *layer = std::lower_bound(m_layers, layersEnd, sum, [](const Layer &layer, std::uint32_t sum) {
+        return layer.tileSum < sum;
+    });
+
+    if (layersEnd == layer || sum != layer->tileSum) {
+        return false;
+    }
+
+    const std::uint64_t key = m_engine->key(canonical);
+    std::uint64_t first = layer->first;
+    std::uint64_t last = (layer + 1)->first;
+
+    while (first < last) {
+        const std::uint64_t middle = first + (last - first) / 2;
+        if (readKey(m_keys, m_keyBytes, middle) < key) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    if (first == (layer + 1)->first || key != readKey(m_keys, m_keyBytes, first)) {
+        return false;
+    }
+
+    const int move = (m_moves[first / MOVES_PER_BYTE] >> (MOVE_BITS * (first % MOVES_PER_BYTE))) & 0x3;
+
+    entry.expectedScore = m_values[first];
+    entry.bestMove = Direction(move);
+
+    // The move was found on the canonical board, the one which maps to it is played on this board
+    for (int direction = 0; direction < 4; ++direction) {
+        if (Direction(move) == BoardEngine::symmetryDirection(Direction(direction), symmetry)) {
+            entry.bestMove = Direction(direction);
+            break;
+        }
+    }
+
+    return true;
+}
+
+
+bool Tablebase::save(const std::string &fileName, const SmallBoardEngine &engine,
+                     const std::vector<TablebaseLayer> &layers, double startScore)
+{
+    TablebaseFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TABLEBASE_FILE_MAGIC, sizeof(header.magic));
+    header.version = TABLEBASE_FILE_VERSION;
+    header.byteOrderMark = BYTE_ORDER_MARK;
+    header.rows = std::uint32_t(engine.rows());
+    header.columns = std::uint32_t(engine.columns());
+    header.keyBytes = std::uint32_t(keyBytes(engine.cells()));
+    header.startScore = startScore;
+
+    std::vector<Layer> fileLayers;
+    for (const TablebaseLayer &layer : layers) {
+        if (layer.boards.empty()) {
+            continue;
+        }
+
+        assert(fileLayers.empty() || fileLayers.back().tileSum < layer.tileSum);
+        fileLayers.push_back({ layer.tileSum, 0, header.statesCount });
+        header.statesCount += layer.boards.size();
+    }
+
+    header.layersCount = std::uint32_t(fileLayers.size());
+    fileLayers.push_back({ 0, 0, header.statesCount });
+
+    std::FILE *file = std::fopen(fileName.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = (1 == std::fwrite(&header, sizeof(header), 1, file));
+    ok = ok && (fileLayers.size() == std::fwrite(fileLayers.data(), sizeof(Layer), fileLayers.size(), file));
+
+    const char padding[SECTION_ALIGNMENT] = {};
+    const int bytes = int(header.keyBytes);
+    std::vector<unsigned char> keys;
+
+    for (auto it = layers.cbegin(); ok && it != layers.cend(); ++it) {
+        keys.resize(it->boards.size() * std::size_t(bytes));
+        for (std::size_t i = 0; i < it->boards.size(); ++i) {
+            writeKey(keys.data() + i * std::size_t(bytes), bytes, engine.key(it->boards[i]));
+        }
+        ok = (keys.size() == std::fwrite(keys.data(), 1, keys.size(), file));
+    }
+
+    std::size_t size = std::size_t(header.statesCount) * std::size_t(bytes);
+    ok = ok && (aligned(size) - size == std::fwrite(padding, 1, aligned(size) - size, file));
+
+    for (auto it = layers.cbegin(); ok && it != layers.cend(); ++it) {
+        ok = (it->values.size() == std::fwrite(it->values.data(), sizeof(float), it->values.size(), file));
+    }
+
+    size = std::size_t(header.statesCount) * sizeof(float);
+    ok = ok && (aligned(size) - size == std::fwrite(padding, 1, aligned(size) - size, file));
+
+    std::uint8_t packed = 0;
+    std::uint64_t index = 0;
+
+    for (auto it = layers.cbegin(); ok && it != layers.cend(); ++it) {
+        for (std::size_t i = 0; ok && i < it->moves.size(); ++i, ++index) {
+            packed |= std::uint8_t(it->moves[i] << (MOVE_BITS * (index % MOVES_PER_BYTE)));
+            if (MOVES_PER_BYTE - 1 == index % MOVES_PER_BYTE) {
+                ok = (1 == std::fwrite(&packed, 1, 1, file));
+                packed = 0;
+            }
+        }
+    }
+
+    if (ok && 0 != index % MOVES_PER_BYTE) {
+        ok = (1 == std::fwrite(&packed, 1, 1, file));
+    }
+
+    return (0 == std::fclose(file)) && ok;
+}
+
+
+std::uint32_t Tablebase::tileSum(Board board)
+{
+    std::uint32_t sum = 0;
+
+    for (; 0 != board; board >>= CELL_BITS) {
+        const int exponent = int(board & CELL_MASK);
+        if (0 != exponent) {
+            sum += std::uint32_t(1) << exponent;
+        }
+    }
+
+    return sum;
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,103 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "boardengine.h"
+
+
+namespace Game {
+namespace Internal {
+
+class SmallBoardEngine;
+
+struct TablebaseEntry
+{
+    // Expected score of the rest of the game under optimal play
+    float expectedScore;
+    Direction bestMove;
+};
+
+// States of one tile sum, sorted by their canonical boards
+struct TablebaseLayer
+{
+    std::uint32_t tileSum;
+    std::vector<Board> boards;
+    std::vector<float> values;
+    std::vector<std::uint8_t> moves;
+};
+
+// Exact values of every reachable state of a small board. The file is used in place,
+// so a memory mapped one only pages in the layers the lookups touch.
+class Tablebase final
+{
+public:
+    Tablebase();
+    ~Tablebase();
+
+    // The data has to outlive the tablebase, nothing is copied
+    bool attach(const void *data, std::size_t size);
+    void detach();
+    bool isAttached() const;
+
+    int rows() const;
+    int columns() const;
+    std::uint64_t statesCount() const;
+    // Expected score of a game from its start tiles
+    double startScore() const;
+
+    // The board sits in the top left corner of the packed board, false for unreachable boards
+    bool lookup(Board board, TablebaseEntry &entry) const;
+
+    static bool save(const std::string &fileName, const SmallBoardEngine &engine,
+                     const std::vector<TablebaseLayer> &layers, double startScore);
+
+    static std::uint32_t tileSum(Board board);
+
+private:
+    Tablebase(const Tablebase &) = delete;
+    Tablebase &operator=(const Tablebase &) = delete;
+
+    struct Layer;
+
+    std::unique_ptr<SmallBoardEngine> m_engine;
+    const Layer *m_layers;
+    std::uint32_t m_layersCount;
+    const unsigned char *m_keys;
+    const float *m_values;
+    const std::uint8_t *m_moves;
+    std::uint64_t m_statesCount;
+    int m_keyBytes;
+    double m_startScore;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // TABLEBASE_H
@@ -0,0 +1,284 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "tablebasegenerator.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+
+static const int START_TILES_COUNT = 2;
+static const double FOUR_TILE_PROBABILITY = 1.0 / Game::Internal::BoardEngine::FOUR_TILE_ODDS;
+static const std::size_t STATES_PER_TASK = 1 << 14;
+
+
+namespace Game {
+namespace Internal {
+
+static void sortBoards(std::vector<Board> &boards)
+{
+    std::sort(boards.begin(), boards.end());
+    boards.erase(std::unique(boards.begin(), boards.end()), boards.end());
+}
+
+
+TablebaseGenerator::TablebaseGenerator(int rows, int columns, ThreadPool *pool) :
+    m_engine(rows, columns),
+    m_pool(pool),
+    m_startScore(0.0)
+{
+    assert(START_TILES_COUNT <= rows * columns);
+}
+
+
+TablebaseGenerator::~TablebaseGenerator()
+{
+}
+
+
+void TablebaseGenerator::generate()
+{
+    m_layers.clear();
+    addStartStates();
+
+    // Layers past the end are added while the ones below them are expanded
+    for (std::size_t index = 0; index < m_layers.size(); ++index) {
+        expandLayer(index);
+    }
+
+    for (std::size_t index = m_layers.size(); 0 < index; --index) {
+        solveLayer(index - 1);
+    }
+
+    // The start tiles are spawned one after another on the empty board
+    const int cells = m_engine.cells();
+    double score = 0.0;
+
+    for (int first = 0; first < cells; ++first) {
+        for (int second = 0; second < cells - 1; ++second) {
+            for (int firstExponent = 1; firstExponent <= 2; ++firstExponent) {
+                for (int secondExponent = 1; secondExponent <= 2; ++secondExponent) {
+                    const Board board = m_engine.spawnTile(m_engine.spawnTile(0, first, firstExponent), second, secondExponent);
+                    const double probability = (1 == firstExponent ? 1.0 - FOUR_TILE_PROBABILITY : FOUR_TILE_PROBABILITY) *
+                                               (1 == secondExponent ? 1.0 - FOUR_TILE_PROBABILITY : FOUR_TILE_PROBABILITY);
+                    score += probability * value(board, Tablebase::tileSum(board) / 2);
+                }
+            }
+        }
+    }
+
+    m_startScore = score / (cells * (cells - 1));
+}
+
+
+std::uint64_t TablebaseGenerator::statesCount() const
+{
+    std::uint64_t count = 0;
+
+    for (const TablebaseLayer &layer : m_layers) {
+        count += layer.boards.size();
+    }
+
+    return count;
+}
+
+
+double TablebaseGenerator::startScore() const
+{
+    return m_startScore;
+}
+
+
+const std::vector<TablebaseLayer> &TablebaseGenerator::layers() const
+{
+    return m_layers;
+}
+
+
+bool TablebaseGenerator::save(const std::string &fileName) const
+{
+    return Tablebase::save(fileName, m_engine, m_layers, m_startScore);
+}
+
+
+void TablebaseGenerator::addStartStates()
+{
+    const int cells = m_engine.cells();
+
+    for (int first = 0; first < cells; ++first) {
+        for (int second = 0; second < cells - 1; ++second) {
+            for (int firstExponent = 1; firstExponent <= 2; ++firstExponent) {
+                for (int secondExponent = 1; secondExponent <= 2; ++secondExponent) {
+                    const Board board = m_engine.spawnTile(m_engine.spawnTile(0, first, firstExponent), second, secondExponent);
+                    const std::size_t index = Tablebase::tileSum(board) / 2;
+
+                    if (m_layers.size() <= index) {
+                        m_layers.resize(index + 1);
+                    }
+
+                    int symmetry = 0;
+                    m_layers[index].boards.push_back(m_engine.canonical(board, symmetry));
+                }
+            }
+        }
+    }
+}
+
+
+// Spawning a two adds the states of the next layer, spawning a four the ones of the layer after it
+void TablebaseGenerator::expandLayer(std::size_t index)
+{
+    if (m_layers.size() < index + 3) {
+        m_layers.resize(index + 3);
+    }
+
+    TablebaseLayer &layer = m_layers[index];
+    layer.tileSum = std::uint32_t(2 * index);
+    sortBoards(layer.boards);
+
+    std::mutex mutex;
+
+    run(layer.boards.size(), [&](std::size_t first, std::size_t last) {
+        std::vector<Board> twos;
+        std::vector<Board> fours;
+        int symmetry = 0;
+
+        for (std::size_t i = first; i < last; ++i) {
+            const Board board = layer.boards[i];
+            const Directions legalMoves = m_engine.legalMoves(board);
+
+            for (int direction = 0; direction < 4; ++direction) {
+                if (0 == (legalMoves & BoardEngine::directionBit(Direction(direction)))) {
+                    continue;
+                }
+
+                const Board afterstate = m_engine.move(board, Direction(direction)).board;
+                for (std::uint64_t cells = m_engine.emptyCells(afterstate); 0 != cells; cells &= cells - 1) {
+                    const Board cell = cells & (0 - cells);
+                    twos.push_back(m_engine.canonical(afterstate | cell, symmetry));
+                    fours.push_back(m_engine.canonical(afterstate | (cell << 1), symmetry));
+                }
+            }
+        }
+
+        sortBoards(twos);
+        sortBoards(fours);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Board> &nextBoards = m_layers[index + 1].boards;
+        std::vector<Board> &afterNextBoards = m_layers[index + 2].boards;
+        nextBoards.insert(nextBoards.end(), twos.cbegin(), twos.cend());
+        afterNextBoards.insert(afterNextBoards.end(), fours.cbegin(), fours.cend());
+    });
+
+    // Trailing layers which nothing reached are dropped
+    while (!m_layers.empty() && m_layers.back().boards.empty()) {
+        m_layers.pop_back();
+    }
+}
+
+
+void TablebaseGenerator::solveLayer(std::size_t index)
+{
+    TablebaseLayer &layer = m_layers[index];
+    layer.values.assign(layer.boards.size(), 0.0f);
+    layer.moves.assign(layer.boards.size(), 0);
+
+    run(layer.boards.size(), [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const Board board = layer.boards[i];
+            const Directions legalMoves = m_engine.legalMoves(board);
+
+            double bestValue = 0.0;
+            int bestMove = -1;
+
+            for (int direction = 0; direction < 4; ++direction) {
+                if (0 == (legalMoves & BoardEngine::directionBit(Direction(direction)))) {
+                    continue;
+                }
+
+                const MoveResult result = m_engine.move(board, Direction(direction));
+                const double value = result.score + afterstateValue(result.board, index);
+
+                if (bestMove < 0 || bestValue < value) {
+                    bestValue = value;
+                    bestMove = direction;
+                }
+            }
+
+            layer.values[i] = float(bestValue);
+            layer.moves[i] = std::uint8_t(std::max(0, bestMove));
+        }
+    });
+}
+
+
+double TablebaseGenerator::afterstateValue(Board board, std::size_t index) const
+{
+    double value = 0.0;
+    int count = 0;
+
+    for (std::uint64_t cells = m_engine.emptyCells(board); 0 != cells; cells &= cells - 1, ++count) {
+        const Board cell = cells & (0 - cells);
+        value += (1.0 - FOUR_TILE_PROBABILITY) * this->value(board | cell, index + 1) +
+                 FOUR_TILE_PROBABILITY * this->value(board | (cell << 1), index + 2);
+    }
+
+    assert(0 < count);
+    return value / count;
+}
+
+
+float TablebaseGenerator::value(Board board, std::size_t index) const
+{
+    int symmetry = 0;
+    const Board canonical = m_engine.canonical(board, symmetry);
+
+    const TablebaseLayer &layer = m_layers[index];
+    const auto it = std::lower_bound(layer.boards.cbegin(), layer.boards.cend(), canonical);
+    assert(layer.boards.cend() != it && canonical == *it);
+
+    return layer.values[std::size_t(it - layer.boards.cbegin())];
+}
+
+
+void TablebaseGenerator::run(std::size_t count, const std::function<void(std::size_t, std::size_t)> &function)
+{
+    const int tasks = int((count + STATES_PER_TASK - 1) / STATES_PER_TASK);
+
+    const auto runTask = [&](int task) {
+        const std::size_t first = std::size_t(task) * STATES_PER_TASK;
+        function(first, std::min(first + STATES_PER_TASK, count));
+    };
+
+    if (m_pool) {
+        m_pool->parallelFor(tasks, runTask);
+    } else {
+        for (int task = 0; task < tasks; ++task) {
+            runTask(task);
+        }
+    }
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,78 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef TABLEBASEGENERATOR_H
+#define TABLEBASEGENERATOR_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "smallboardengine.h"
+#include "tablebase.h"
+
+
+namespace Game {
+namespace Internal {
+
+class ThreadPool;
+
+// Enumerates every state of a small board reachable from the start tiles and solves them exactly.
+// A move keeps the tile sum and a spawn raises it, so the states are layered by their sums:
+// they are found from the lowest layer up and solved from the highest one down.
+class TablebaseGenerator final
+{
+public:
+    TablebaseGenerator(int rows, int columns, ThreadPool *pool = nullptr);
+    ~TablebaseGenerator();
+
+    void generate();
+
+    std::uint64_t statesCount() const;
+    double startScore() const;
+    const std::vector<TablebaseLayer> &layers() const;
+
+    bool save(const std::string &fileName) const;
+
+private:
+    TablebaseGenerator(const TablebaseGenerator &) = delete;
+    TablebaseGenerator &operator=(const TablebaseGenerator &) = delete;
+
+    void addStartStates();
+    void expandLayer(std::size_t index);
+    void solveLayer(std::size_t index);
+    double afterstateValue(Board board, std::size_t index) const;
+    float value(Board board, std::size_t index) const;
+    void run(std::size_t count, const std::function<void(std::size_t, std::size_t)> &function);
+
+    const SmallBoardEngine m_engine;
+    ThreadPool *const m_pool;
+    // Indexed by half the tile sum, the sum of the twos
+    std::vector<TablebaseLayer> m_layers;
+    double m_startScore;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // TABLEBASEGENERATOR_H
@@ -0,0 +1,177 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "tdtrainer.h"
+#include "ntuplenetwork.h"
+#include "randomgenerator.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+static const float DEFAULT_LEARNING_RATE = 0.0025f;
+
+
+namespace Game {
+namespace Internal {
+
+double TrainingStatistics::gamesPerSecond() const
+{
+    return (0.0 < seconds) ? games / seconds : 0.0;
+}
+
+
+double TrainingStatistics::meanScore() const
+{
+    return (0 < games) ? double(totalScore) / games : 0.0;
+}
+
+
+double TrainingStatistics::winRate() const
+{
+    return (0 < games) ? double(wins) / games : 0.0;
+}
+
+
+TdTrainer::TdTrainer(NTupleNetwork &network, ThreadPool *pool, std::uint64_t seed) :
+    m_network(network),
+    m_pool(pool),
+    m_seed(seed),
+    m_games(0),
+    m_learningRate(DEFAULT_LEARNING_RATE)
+{
+}
+
+
+float TdTrainer::learningRate() const
+{
+    return m_learningRate;
+}
+
+
+void TdTrainer::setLearningRate(float learningRate)
+{
+    assert(0.0f < learningRate);
+    m_learningRate = learningRate;
+}
+
+
+TrainingStatistics TdTrainer::train(int games)
+{
+    assert(0 <= games);
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::uint64_t firstGame = m_games;
+    m_games += std::uint64_t(games);
+
+    std::vector<GameResult> results(static_cast<std::size_t>(games));
+
+    const auto runGame = [&](int index) {
+        RandomGenerator random(m_seed, firstGame + std::uint64_t(index));
+        results[std::size_t(index)] = playGame(random);
+    };
+
+    if (m_pool) {
+        m_pool->parallelFor(games, runGame);
+    } else {
+        for (int index = 0; index < games; ++index) {
+            runGame(index);
+        }
+    }
+
+    TrainingStatistics statistics;
+    statistics.games = games;
+    statistics.wins = 0;
+    statistics.moves = 0;
+    statistics.totalScore = 0;
+    statistics.maxScore = 0;
+
+    for (const GameResult &result : results) {
+        statistics.wins += (WIN_EXPONENT <= result.maxExponent) ? 1 : 0;
+        statistics.moves += result.moves;
+        statistics.totalScore += result.score;
+        statistics.maxScore = std::max(statistics.maxScore, result.score);
+    }
+
+    statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return statistics;
+}
+
+
+TdTrainer::GameResult TdTrainer::playGame(RandomGenerator &random)
+{
+    GameResult result = { 0, 0, 0 };
+
+    Board board = BoardEngine::spawnRandomTile(BoardEngine::spawnRandomTile(0, random), random);
+    Board afterstate = 0;
+    float afterstateValue = 0.0f;
+
+    for (Directions legalMoves = BoardEngine::legalMoves(board); 0 != legalMoves;
+         legalMoves = BoardEngine::legalMoves(board)) {
+        MoveResult best = { 0, 0, 0 };
+        float bestValue = std::numeric_limits<float>::lowest();
+        float bestAfterstateValue = 0.0f;
+
+        for (int move = 0; move < 4; ++move) {
+            if (0 == (legalMoves & BoardEngine::directionBit(Direction(move)))) {
+                continue;
+            }
+
+            const MoveResult moved = BoardEngine::move(board, Direction(move));
+            const float value = m_network.evaluate(moved.board);
+
+            if (bestValue < moved.score + value) {
+                bestValue = moved.score + value;
+                bestAfterstateValue = value;
+                best = moved;
+            }
+        }
+
+        // The previous afterstate learns the reward and the value of the next one
+        if (0 < result.moves) {
+            m_network.update(afterstate, m_learningRate * (bestValue - afterstateValue));
+        }
+
+        afterstate = best.board;
+        afterstateValue = bestAfterstateValue;
+        result.score += std::uint32_t(best.score);
+        ++result.moves;
+
+        board = BoardEngine::spawnRandomTile(best.board, random);
+    }
+
+    // Nothing follows the last afterstate
+    if (0 < result.moves) {
+        m_network.update(afterstate, -m_learningRate * afterstateValue);
+    }
+
+    result.maxExponent = BoardEngine::maxExponent(board);
+
+    return result;
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,87 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef TDTRAINER_H
+#define TDTRAINER_H
+
+#include <cstdint>
+
+#include "boardengine.h"
+
+
+namespace Game {
+namespace Internal {
+
+class NTupleNetwork;
+class RandomGenerator;
+class ThreadPool;
+
+struct TrainingStatistics
+{
+    int games;
+    int wins;
+    std::uint64_t moves;
+    std::uint64_t totalScore;
+    std::uint32_t maxScore;
+    double seconds;
+
+    double gamesPerSecond() const;
+    double meanScore() const;
+    double winRate() const;
+};
+
+// Trains the network on greedy self-play games with TD(0) on afterstates.
+// Every game is a pool task with its own (seed, counter) random stream and all of them update
+// the shared weights without locks, so a run with more than one thread isn't reproducible.
+class TdTrainer final
+{
+public:
+    static const int WIN_EXPONENT = 11;
+
+    explicit TdTrainer(NTupleNetwork &network, ThreadPool *pool = nullptr, std::uint64_t seed = 0);
+
+    float learningRate() const;
+    void setLearningRate(float learningRate);
+
+    TrainingStatistics train(int games);
+
+private:
+    struct GameResult
+    {
+        std::uint64_t moves;
+        std::uint32_t score;
+        int maxExponent;
+    };
+
+    GameResult playGame(RandomGenerator &random);
+
+    NTupleNetwork &m_network;
+    ThreadPool *const m_pool;
+    const std::uint64_t m_seed;
+    std::uint64_t m_games;
+    float m_learningRate;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // TDTRAINER_H
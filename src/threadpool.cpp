@@ -0,0 +1,215 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "threadpool.h"
+
+#include <cassert>
+#include <deque>
+
+
+namespace Game {
+namespace Internal {
+
+struct ThreadPool::Queue
+{
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+
+static thread_local const ThreadPool *currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+
+TaskGroup::TaskGroup() :
+    m_pending(0)
+{
+}
+
+
+ThreadPool::ThreadPool(int threads) :
+    m_queuedTasks(0),
+    m_stopping(false)
+{
+    if (threads <= 0) {
+        threads = int(std::thread::hardware_concurrency());
+    }
+
+    // The last queue takes the tasks of the threads outside the pool
+    const int workers = (threads < 1 ? 1 : threads) - 1;
+    for (int i = 0; i <= workers; ++i) {
+        m_queues.emplace_back(new Queue);
+    }
+
+    for (int i = 0; i < workers; ++i) {
+        m_workers.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+
+    m_taskQueued.notify_all();
+
+    for (auto &worker : m_workers) {
+        worker.join();
+    }
+}
+
+
+int ThreadPool::threads() const
+{
+    return int(m_workers.size()) + 1;
+}
+
+
+void ThreadPool::run(TaskGroup &group, Task task)
+{
+    group.m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    Queue &queue = *m_queues[std::size_t(currentQueue())];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.emplace_back([&group, task]() {
+            task();
+            group.m_pending.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    m_queuedTasks.fetch_add(1, std::memory_order_release);
+    {
+        // A worker between its check and its wait holds the mutex, so the notification can't be lost
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_taskQueued.notify_one();
+}
+
+
+void ThreadPool::wait(TaskGroup &group)
+{
+    const int queue = currentQueue();
+    Task task;
+
+    while (0 != group.m_pending.load(std::memory_order_acquire)) {
+        if (popTask(queue, task) || stealTask(queue, task)) {
+            task();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)> &function)
+{
+    if (m_workers.empty() || count <= 1) {
+        for (int index = 0; index < count; ++index) {
+            function(index);
+        }
+        return;
+    }
+
+    TaskGroup group;
+
+    for (int index = 0; index < count; ++index) {
+        run(group, [&function, index]() { function(index); });
+    }
+
+    wait(group);
+}
+
+
+void ThreadPool::work(int queue)
+{
+    currentPool = this;
+    currentWorker = queue;
+
+    Task task;
+
+    for (;;) {
+        if (popTask(queue, task) || stealTask(queue, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_taskQueued.wait(lock, [this]() { return m_stopping || 0 < m_queuedTasks.load(std::memory_order_acquire); });
+
+        if (m_stopping) {
+            return;
+        }
+    }
+}
+
+
+int ThreadPool::currentQueue() const
+{
+    return (this == currentPool) ? currentWorker : int(m_queues.size()) - 1;
+}
+
+
+bool ThreadPool::popTask(int queue, Task &task)
+{
+    Queue &own = *m_queues[std::size_t(queue)];
+    std::lock_guard<std::mutex> lock(own.mutex);
+
+    if (own.tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(own.tasks.back());
+    own.tasks.pop_back();
+    m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+
+bool ThreadPool::stealTask(int queue, Task &task)
+{
+    const int queues = int(m_queues.size());
+
+    for (int i = 1; i < queues; ++i) {
+        Queue &victim = *m_queues[std::size_t((queue + i) % queues)];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (victim.tasks.empty()) {
+            continue;
+        }
+
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace Internal
+} // namespace Game
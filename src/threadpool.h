@@ -0,0 +1,94 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace Game {
+namespace Internal {
+
+class TaskGroup final
+{
+public:
+    TaskGroup();
+
+private:
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    std::atomic<int> m_pending;
+
+    friend class ThreadPool;
+};
+
+// Work-stealing pool. Every worker owns a task deque, runs its own tasks newest first and
+// steals the oldest ones of the others when it runs dry. Threads waiting for a group run tasks too,
+// so tasks can spawn and wait for more tasks.
+class ThreadPool final
+{
+public:
+    using Task = std::function<void()>;
+
+    // Zero threads means one per hardware thread, a thread waiting for tasks is one of them
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    int threads() const;
+
+    void run(TaskGroup &group, Task task);
+    void wait(TaskGroup &group);
+
+    // Calls function for every index in [0, count) as separate tasks and waits for them
+    void parallelFor(int count, const std::function<void(int)> &function);
+
+private:
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    struct Queue;
+
+    void work(int queue);
+    int currentQueue() const;
+    bool popTask(int queue, Task &task);
+    bool stealTask(int queue, Task &task);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<int> m_queuedTasks;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_taskQueued;
+    bool m_stopping;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // THREADPOOL_H
@@ -34,6 +34,7 @@ static const char *const HEIGHT_PROPERTY_NAME = "height";
 static const char *const VALUE_PROPERTY_NAME = "value";
 static const char *const ANIMATION_PROPERTY_NAME = "animation";
 static const char *const HIDDEN_PROPERTY_NAME = "hidden";
+static const char *const MOVE_ANIMATION_PROPERTY_NAME = "moveAnimation";
 
 
 namespace Game {
@@ -43,7 +44,8 @@ Tile::Tile(int id, int value, QQuickItem *tileItem, QQuickItem *parent) :
     QObject(parent),
     m_tileItem(tileItem),
     m_id(id),
-    m_value(value)
+    m_value(value),
+    m_moveAnimationEnabled(true)
 {
     m_tileItem->setParentItem(parent);
 #ifdef QT_DEBUG
@@ -83,6 +85,11 @@ void Tile::setValue(int value)
 {
     if (m_value != value) {
         m_value = value;
+
+        // There is no move to wait for
+        if (!m_moveAnimationEnabled) {
+            m_tileItem->setProperty(VALUE_PROPERTY_NAME, m_value);
+        }
     }
 }
 
@@ -102,6 +109,21 @@ void Tile::show(bool animation)
 }
 
 
+bool Tile::isMoveAnimationEnabled() const
+{
+    return m_moveAnimationEnabled;
+}
+
+
+void Tile::setMoveAnimationEnabled(bool enabled)
+{
+    if (m_moveAnimationEnabled != enabled) {
+        m_moveAnimationEnabled = enabled;
+        m_tileItem->setProperty(MOVE_ANIMATION_PROPERTY_NAME, enabled);
+    }
+}
+
+
 Cell_ptr Tile::cell() const
 {
     return m_cell.lock();
@@ -54,6 +54,10 @@ public:
     void hide(bool animation = true);
     void show(bool animation = true);
 
+    // Without the move animation a tile jumps to its cell and shows its new value at once
+    bool isMoveAnimationEnabled() const;
+    void setMoveAnimationEnabled(bool enabled);
+
     Cell_ptr cell() const;
     void setCell(const Cell_ptr &cell);
 
@@ -78,6 +82,7 @@ private:
     const std::unique_ptr<QQuickItem> m_tileItem;
     int m_id;
     int m_value;
+    bool m_moveAnimationEnabled;
     std::weak_ptr<Cell> m_cell;
 };
 
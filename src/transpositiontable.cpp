@@ -0,0 +1,299 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "transpositiontable.h"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+static const int COUNTERS_SHARDS = 64;
+static const int CACHE_LINE_SIZE = 64;
+
+static const int TAG_SHIFT = 48;
+static const int DEPTH_SHIFT = 40;
+static const int GENERATION_SHIFT = 32;
+static const std::uint64_t BYTE_MASK = 0xFF;
+static const std::uint64_t VALUE_MASK = 0xFFFFFFFF;
+
+
+namespace Game {
+namespace Internal {
+
+// Each shard owns a whole cache line, so the threads don't fight over one
+struct alignas(CACHE_LINE_SIZE) TranspositionTable::Counters
+{
+    std::atomic<std::uint64_t> lookups;
+    std::atomic<std::uint64_t> hits;
+    std::atomic<std::uint64_t> stores;
+    std::atomic<std::uint64_t> collisions;
+    std::atomic<std::uint64_t> probes;
+};
+
+
+static std::uint64_t hashBoard(Board board)
+{
+    board ^= board >> 33;
+    board *= 0xFF51AFD7ED558CCDULL;
+    board ^= board >> 33;
+    board *= 0xC4CEB9FE1A85EC53ULL;
+    return board ^ (board >> 33);
+}
+
+
+static std::uint64_t tagOf(std::uint64_t hash)
+{
+    // Zero tags mark the empty entries
+    const std::uint64_t tag = hash >> TAG_SHIFT;
+    return 0 == tag ? 1 : tag;
+}
+
+
+static std::size_t roundUpToPowerOfTwo(std::size_t value)
+{
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+
+static std::uint32_t floatBits(float value)
+{
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+
+static float bitsFloat(std::uint32_t bits)
+{
+    float value = 0.0f;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+
+static int counterShard()
+{
+    static std::atomic<int> nextShard(0);
+    static thread_local const int shard = nextShard.fetch_add(1, std::memory_order_relaxed) % COUNTERS_SHARDS;
+    return shard;
+}
+
+
+double TranspositionStatistics::hitRate() const
+{
+    return 0 == lookups ? 0.0 : double(hits) / lookups;
+}
+
+
+double TranspositionStatistics::averageProbeLength() const
+{
+    return 0 == lookups ? 0.0 : double(probes) / lookups;
+}
+
+
+TranspositionTable::TranspositionTable(std::size_t entries, ReplacementPolicy policy) :
+    m_entries(roundUpToPowerOfTwo(entries < std::size_t(PROBE_LENGTH) ? std::size_t(PROBE_LENGTH) : entries)),
+    m_mask(m_entries - 1),
+    m_policy(policy),
+    m_table(new std::atomic<std::uint64_t>[m_entries]),
+    m_counterStorage(new char[(COUNTERS_SHARDS + 1) * CACHE_LINE_SIZE]),
+    m_counters(nullptr),
+    m_generation(0)
+{
+    static_assert(sizeof(Counters) == CACHE_LINE_SIZE, "Counters must fill one cache line");
+    static_assert(std::is_trivially_destructible<Counters>::value, "Counters are released without destructors");
+
+    // Plain new doesn't honour the over-alignment before C++17, so the shards are
+    // placed on the first cache line boundary of a buffer one line larger
+    void *storage = m_counterStorage.get();
+    std::size_t space = (COUNTERS_SHARDS + 1) * CACHE_LINE_SIZE;
+    storage = std::align(CACHE_LINE_SIZE, COUNTERS_SHARDS * sizeof(Counters), storage, space);
+    assert(storage);
+    m_counters = static_cast<Counters *>(storage);
+    for (int shard = 0; shard < COUNTERS_SHARDS; ++shard)
+        new (m_counters + shard) Counters();
+
+    clear();
+    resetStatistics();
+}
+
+
+TranspositionTable::~TranspositionTable() = default;
+
+
+std::size_t TranspositionTable::entries() const
+{
+    return m_entries;
+}
+
+
+std::size_t TranspositionTable::bytes() const
+{
+    return m_entries * sizeof(std::uint64_t);
+}
+
+
+ReplacementPolicy TranspositionTable::policy() const
+{
+    return m_policy;
+}
+
+
+bool TranspositionTable::lookup(Board board, int depth, float &value) const
+{
+    const std::uint64_t hash = hashBoard(board);
+    const std::uint64_t tag = tagOf(hash);
+    Counters &counter = counters();
+
+    counter.lookups.fetch_add(1, std::memory_order_relaxed);
+
+    for (int probe = 0; probe < PROBE_LENGTH; ++probe) {
+        const std::uint64_t entry = m_table[(hash + std::uint64_t(probe)) & m_mask].load(std::memory_order_relaxed);
+        const std::uint64_t entryTag = entry >> TAG_SHIFT;
+
+        if (0 == entryTag || tag == entryTag) {
+            counter.probes.fetch_add(std::uint64_t(probe + 1), std::memory_order_relaxed);
+
+            if (0 == entryTag || int((entry >> DEPTH_SHIFT) & BYTE_MASK) < depth) {
+                return false;
+            }
+
+            value = bitsFloat(std::uint32_t(entry & VALUE_MASK));
+            counter.hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    counter.probes.fetch_add(PROBE_LENGTH, std::memory_order_relaxed);
+    return false;
+}
+
+
+void TranspositionTable::store(Board board, int depth, float value)
+{
+    assert(0 <= depth && depth <= MAX_DEPTH);
+
+    const std::uint64_t hash = hashBoard(board);
+    const std::uint64_t tag = tagOf(hash);
+    const std::uint64_t generation = m_generation.load(std::memory_order_relaxed) & BYTE_MASK;
+    const std::uint64_t entry = (tag << TAG_SHIFT) | (std::uint64_t(depth) << DEPTH_SHIFT) |
+                                (generation << GENERATION_SHIFT) | floatBits(value);
+
+    std::size_t victim = hash & m_mask;
+    int victimScore = -1;
+
+    for (int probe = 0; probe < PROBE_LENGTH; ++probe) {
+        const std::size_t index = (hash + std::uint64_t(probe)) & m_mask;
+        const std::uint64_t current = m_table[index].load(std::memory_order_relaxed);
+        const std::uint64_t currentTag = current >> TAG_SHIFT;
+
+        if (0 == currentTag || tag == currentTag) {
+            if (0 != currentTag && ReplacementPolicy::Always != m_policy
+                    && int((current >> DEPTH_SHIFT) & BYTE_MASK) > depth) {
+                return;
+            }
+            victim = index;
+            victimScore = -1;
+            break;
+        }
+
+        if (ReplacementPolicy::Always == m_policy) {
+            victimScore = 0;
+            break;
+        }
+
+        // The lower the score, the more the entry is worth keeping
+        int score = MAX_DEPTH - int((current >> DEPTH_SHIFT) & BYTE_MASK);
+        if (ReplacementPolicy::Generation == m_policy && generation != ((current >> GENERATION_SHIFT) & BYTE_MASK)) {
+            score += MAX_DEPTH + 1;
+        }
+
+        if (victimScore < score) {
+            victimScore = score;
+            victim = index;
+        }
+    }
+
+    Counters &counter = counters();
+    counter.stores.fetch_add(1, std::memory_order_relaxed);
+    if (0 <= victimScore) {
+        counter.collisions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    m_table[victim].store(entry, std::memory_order_relaxed);
+}
+
+
+void TranspositionTable::newSearch()
+{
+    m_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void TranspositionTable::clear()
+{
+    for (std::size_t index = 0; index < m_entries; ++index) {
+        m_table[index].store(0, std::memory_order_relaxed);
+    }
+}
+
+
+TranspositionStatistics TranspositionTable::statistics() const
+{
+    TranspositionStatistics result = { 0, 0, 0, 0, 0 };
+
+    for (int shard = 0; shard < COUNTERS_SHARDS; ++shard) {
+        result.lookups += m_counters[shard].lookups.load(std::memory_order_relaxed);
+        result.hits += m_counters[shard].hits.load(std::memory_order_relaxed);
+        result.stores += m_counters[shard].stores.load(std::memory_order_relaxed);
+        result.collisions += m_counters[shard].collisions.load(std::memory_order_relaxed);
+        result.probes += m_counters[shard].probes.load(std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+
+void TranspositionTable::resetStatistics()
+{
+    for (int shard = 0; shard < COUNTERS_SHARDS; ++shard) {
+        m_counters[shard].lookups.store(0, std::memory_order_relaxed);
+        m_counters[shard].hits.store(0, std::memory_order_relaxed);
+        m_counters[shard].stores.store(0, std::memory_order_relaxed);
+        m_counters[shard].collisions.store(0, std::memory_order_relaxed);
+        m_counters[shard].probes.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+TranspositionTable::Counters &TranspositionTable::counters() const
+{
+    return m_counters[counterShard()];
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,107 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "boardengine.h"
+
+
+namespace Game {
+namespace Internal {
+
+enum class ReplacementPolicy : std::uint8_t
+{
+    // The first probed slot is overwritten
+    Always,
+    // The shallowest entry of the probed slots is overwritten
+    Depth,
+    // Entries of older searches are overwritten first, then the shallowest ones
+    Generation
+};
+
+struct TranspositionStatistics
+{
+    std::uint64_t lookups;
+    std::uint64_t hits;
+    std::uint64_t stores;
+    // Stores which evicted the entry of another board
+    std::uint64_t collisions;
+    // Slots visited by all lookups
+    std::uint64_t probes;
+
+    double hitRate() const;
+    double averageProbeLength() const;
+};
+
+// Fixed size hash table shared by search threads without locks. Every entry is a single 64-bit word
+// holding the value, the depth, the search generation and a 16-bit tag of the board hash, so readers
+// never see a torn entry. Tags can collide, a lookup then returns the value of another board.
+class TranspositionTable final
+{
+public:
+    static const int PROBE_LENGTH = 4;
+    static const int MAX_DEPTH = 255;
+
+    // The entries count is rounded up to a power of two
+    explicit TranspositionTable(std::size_t entries, ReplacementPolicy policy = ReplacementPolicy::Depth);
+    ~TranspositionTable();
+
+    std::size_t entries() const;
+    std::size_t bytes() const;
+    ReplacementPolicy policy() const;
+
+    bool lookup(Board board, int depth, float &value) const;
+    void store(Board board, int depth, float value);
+
+    // Makes the entries of earlier searches the first ones to replace
+    void newSearch();
+    void clear();
+
+    TranspositionStatistics statistics() const;
+    void resetStatistics();
+
+private:
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    struct Counters;
+
+    Counters &counters() const;
+
+    const std::size_t m_entries;
+    const std::size_t m_mask;
+    const ReplacementPolicy m_policy;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> m_table;
+    std::unique_ptr<char[]> m_counterStorage;
+    Counters *m_counters;
+    std::atomic<std::uint32_t> m_generation;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // TRANSPOSITIONTABLE_H
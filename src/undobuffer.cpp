@@ -0,0 +1,130 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "undobuffer.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace Game {
+namespace Internal {
+
+UndoBuffer::UndoBuffer(int capacity) :
+    m_capacity(capacity),
+    m_cells(0),
+    m_first(0),
+    m_size(0),
+    m_turns(std::size_t(capacity))
+{
+    assert(0 < capacity);
+}
+
+
+void UndoBuffer::reset(int cells)
+{
+    assert(0 <= cells);
+
+    m_cells = cells;
+    m_exponents.assign(std::size_t(m_capacity * cells), 0);
+    m_tileIds.assign(std::size_t(m_capacity * cells), 0);
+    clear();
+}
+
+
+void UndoBuffer::clear()
+{
+    m_first = 0;
+    m_size = 0;
+}
+
+
+bool UndoBuffer::isEmpty() const
+{
+    return 0 == m_size;
+}
+
+
+int UndoBuffer::size() const
+{
+    return m_size;
+}
+
+
+int UndoBuffer::capacity() const
+{
+    return m_capacity;
+}
+
+
+void UndoBuffer::push(const UndoTurn &turn, const std::uint8_t *exponents, const std::int32_t *tileIds)
+{
+    if (m_capacity == m_size) {
+        m_first = (m_first + 1) % m_capacity;
+    } else {
+        ++m_size;
+    }
+
+    const int slot = topSlot();
+    const std::size_t offset = std::size_t(slot * m_cells);
+
+    m_turns[std::size_t(slot)] = turn;
+    std::copy(exponents, exponents + m_cells, m_exponents.begin() + std::ptrdiff_t(offset));
+    std::copy(tileIds, tileIds + m_cells, m_tileIds.begin() + std::ptrdiff_t(offset));
+}
+
+
+void UndoBuffer::pop()
+{
+    assert(!isEmpty());
+    --m_size;
+}
+
+
+const UndoTurn &UndoBuffer::top() const
+{
+    assert(!isEmpty());
+    return m_turns[std::size_t(topSlot())];
+}
+
+
+const std::uint8_t *UndoBuffer::topExponents() const
+{
+    assert(!isEmpty());
+    return m_exponents.data() + topSlot() * m_cells;
+}
+
+
+const std::int32_t *UndoBuffer::topTileIds() const
+{
+    assert(!isEmpty());
+    return m_tileIds.data() + topSlot() * m_cells;
+}
+
+
+int UndoBuffer::topSlot() const
+{
+    return (m_first + m_size - 1) % m_capacity;
+}
+
+} // namespace Internal
+} // namespace Game
@@ -0,0 +1,75 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef UNDOBUFFER_H
+#define UNDOBUFFER_H
+
+#include <cstdint>
+#include <vector>
+
+
+namespace Game {
+namespace Internal {
+
+struct UndoTurn
+{
+    int turnId;
+    int parentTurnId;
+    int score;
+};
+
+// Bounded ring of board snapshots, the oldest one is dropped when it is full
+class UndoBuffer final
+{
+public:
+    explicit UndoBuffer(int capacity);
+
+    void reset(int cells);
+    void clear();
+
+    bool isEmpty() const;
+    int size() const;
+    int capacity() const;
+
+    void push(const UndoTurn &turn, const std::uint8_t *exponents, const std::int32_t *tileIds);
+    void pop();
+
+    const UndoTurn &top() const;
+    const std::uint8_t *topExponents() const;
+    const std::int32_t *topTileIds() const;
+
+private:
+    int topSlot() const;
+
+    const int m_capacity;
+    int m_cells;
+    int m_first;
+    int m_size;
+    std::vector<UndoTurn> m_turns;
+    std::vector<std::uint8_t> m_exponents;
+    std::vector<std::int32_t> m_tileIds;
+};
+
+} // namespace Internal
+} // namespace Game
+
+#endif // UNDOBUFFER_H
@@ -0,0 +1,325 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "bitoperations.h"
+#include "movekernel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_KERNEL_AVAILABLE
+#define VECTOR_KERNEL_TARGET __attribute__((target("sse4.1")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define VECTOR_KERNEL_AVAILABLE
+#define VECTOR_KERNEL_TARGET
+#endif
+
+#ifdef VECTOR_KERNEL_AVAILABLE
+#include <smmintrin.h>
+#endif
+
+#if defined(VECTOR_KERNEL_AVAILABLE) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static const int MAX_LINE_LENGTH = 16;
+static const int MAX_CELLS = MAX_LINE_LENGTH * MAX_LINE_LENGTH;
+static const int SSE41_CPUID_BIT = 19;
+
+
+namespace Game {
+namespace Internal {
+
+#ifdef VECTOR_KERNEL_AVAILABLE
+
+namespace {
+
+struct CompactTable
+{
+    CompactTable()
+    {
+        for (int mask = 0; mask < 256; ++mask) {
+            int count = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (0 != (mask & (1 << bit))) {
+                    indices[mask][count++] = std::uint8_t(bit);
+                }
+            }
+            while (count < 8) {
+                indices[mask][count++] = 0x80;
+            }
+        }
+    }
+
+    // Byte positions of the set mask bits, padded with the zeroing shuffle index
+    std::uint8_t indices[256][8];
+};
+
+
+const CompactTable &compactTable()
+{
+    static const CompactTable table;
+    return table;
+}
+
+
+struct RowResult
+{
+    int score;
+    int merges;
+    int moves;
+};
+
+
+// Shuffle which packs the bytes selected by a 16-bit mask to the front of the register
+VECTOR_KERNEL_TARGET
+__m128i compactShuffle(const CompactTable &table, unsigned mask)
+{
+    std::uint8_t buffer[24];
+    std::memset(buffer + 8, 0x80, 16);
+    std::memcpy(buffer, table.indices[mask & 0xFF], 8);
+
+    const __m128i high = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(table.indices[(mask >> 8) & 0xFF]));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(buffer + popCount(mask & 0xFF)), _mm_add_epi8(high, _mm_set1_epi8(8)));
+
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer));
+}
+
+
+VECTOR_KERNEL_TARGET
+__m128i expandMask(unsigned mask)
+{
+    const __m128i bytes = _mm_shuffle_epi8(_mm_set1_epi16(short(mask)),
+                                           _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1));
+    const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    return _mm_cmpeq_epi8(_mm_and_si128(bytes, bits), bits);
+}
+
+
+VECTOR_KERNEL_TARGET
+__m128i reverseShuffle(int length)
+{
+    std::uint8_t buffer[MAX_LINE_LENGTH];
+
+    for (int position = 0; position < MAX_LINE_LENGTH; ++position) {
+        buffer[position] = position < length ? std::uint8_t(length - 1 - position) : std::uint8_t(0x80);
+    }
+
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer));
+}
+
+
+// Slides one line towards position 0. The line bytes past its length must be zero.
+// When targets is not null it receives the target position of every tile, -1 for empty positions.
+VECTOR_KERNEL_TARGET
+RowResult moveLine(const CompactTable &table, __m128i &line, std::int8_t *targets)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const unsigned tiles = ~unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(line, zero))) & 0xFFFF;
+    const int count = popCount(tiles);
+
+    const __m128i sources = compactShuffle(table, tiles);
+    const __m128i packed = _mm_shuffle_epi8(line, sources);
+
+    const unsigned tilesMask = (1u << count) - 1;
+    unsigned equal = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(packed, _mm_srli_si128(packed, 1)))) & tilesMask;
+
+    // Runs of equal tiles are paired starting from the wall
+    unsigned merges = 0;
+    while (0 != equal) {
+        const unsigned bit = equal & (0u - equal);
+        merges |= bit;
+        equal &= ~(bit | (bit << 1));
+    }
+
+    RowResult result = { 0, popCount(merges), 0 };
+
+    if (0 == merges) {
+        line = packed;
+    } else {
+        const __m128i merged = _mm_andnot_si128(expandMask(merges << 1), _mm_sub_epi8(packed, expandMask(merges)));
+        line = _mm_shuffle_epi8(merged, compactShuffle(table, tilesMask & ~(merges << 1)));
+
+        std::uint8_t exponents[MAX_LINE_LENGTH];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(exponents), packed);
+        for (unsigned bits = merges; 0 != bits; bits &= bits - 1) {
+            result.score += 1 << (exponents[countTrailingZeros(bits)] + 1);
+        }
+    }
+
+    // Only a wall-side prefix of tiles which are already in place and merge nothing before them stays still
+    const int inPlace = countTrailingZeros(~std::uint64_t(tiles));
+    const int firstMerge = 0 == merges ? MAX_LINE_LENGTH : countTrailingZeros(merges) + 1;
+    result.moves = count - std::min(inPlace, firstMerge);
+
+    if (targets) {
+        std::uint8_t sourcePositions[MAX_LINE_LENGTH];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sourcePositions), sources);
+        std::fill(targets, targets + MAX_LINE_LENGTH, std::int8_t(-1));
+        for (int position = 0; position < count; ++position) {
+            const unsigned before = merges & ((1u << position) - 1);
+            targets[sourcePositions[position]] = std::int8_t(position - popCount(before));
+        }
+    }
+
+    return result;
+}
+
+
+VECTOR_KERNEL_TARGET
+KernelResult moveLines(const CompactTable &table, std::uint8_t *cells, int lines, int length,
+                       bool reverse, std::int16_t *targets)
+{
+    KernelResult result = { 0, 0, 0 };
+
+    const __m128i reverseLine = reverseShuffle(length);
+    std::int8_t lineTargets[MAX_LINE_LENGTH];
+
+    for (int lineIndex = 0; lineIndex < lines; ++lineIndex) {
+        std::uint8_t *lineCells = cells + lineIndex * length;
+
+        std::uint8_t buffer[MAX_LINE_LENGTH] = {};
+        std::memcpy(buffer, lineCells, std::size_t(length));
+        __m128i line = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer));
+
+        if (reverse) {
+            line = _mm_shuffle_epi8(line, reverseLine);
+        }
+
+        const RowResult rowResult = moveLine(table, line, targets ? lineTargets : nullptr);
+        result.score += rowResult.score;
+        result.merges += rowResult.merges;
+        result.moves += rowResult.moves;
+
+        if (reverse) {
+            line = _mm_shuffle_epi8(line, reverseLine);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer), line);
+        std::memcpy(lineCells, buffer, std::size_t(length));
+
+        if (targets) {
+            for (int position = 0; position < length; ++position) {
+                const int source = reverse ? length - 1 - position : position;
+                const int target = lineTargets[position];
+                targets[lineIndex * length + source] = std::int16_t(
+                        target < 0 ? -1 : lineIndex * length + (reverse ? length - 1 - target : target));
+            }
+        }
+    }
+
+    return result;
+}
+
+
+void transpose(const std::uint8_t *source, std::uint8_t *target, int rows, int columns)
+{
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            target[column * rows + row] = source[row * columns + column];
+        }
+    }
+}
+
+
+bool cpuSupportsVectorKernel()
+{
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.1");
+#else
+    int info[4] = {};
+    __cpuid(info, 1);
+    return 0 != (info[2] & (1 << SSE41_CPUID_BIT));
+#endif
+}
+
+} // namespace
+
+
+bool MoveKernels::hasVectorKernel()
+{
+    static const bool supported = cpuSupportsVectorKernel();
+    return supported;
+}
+
+
+KernelResult MoveKernels::moveVectorCells(std::uint8_t *cells, int rows, int columns,
+                                          Direction direction, std::int16_t *targets)
+{
+    assert(hasVectorKernel());
+    assert(0 < rows && rows <= MAX_LINE_LENGTH);
+    assert(0 < columns && columns <= MAX_LINE_LENGTH);
+
+    const CompactTable &table = compactTable();
+
+    switch (direction) {
+    case Direction::Left:
+    case Direction::Right:
+        return moveLines(table, cells, rows, columns, Direction::Right == direction, targets);
+    case Direction::Up:
+    case Direction::Down:
+        break;
+    }
+
+    // Columns are moved as the rows of the transposed board
+    std::uint8_t transposed[MAX_CELLS];
+    std::int16_t transposedTargets[MAX_CELLS];
+    transpose(cells, transposed, rows, columns);
+
+    const KernelResult result = moveLines(table, transposed, columns, rows, Direction::Down == direction,
+                                          targets ? transposedTargets : nullptr);
+
+    transpose(transposed, cells, columns, rows);
+
+    if (targets) {
+        for (int column = 0; column < columns; ++column) {
+            for (int row = 0; row < rows; ++row) {
+                const int target = transposedTargets[column * rows + row];
+                targets[row * columns + column] = std::int16_t(target < 0 ? -1 : (target % rows) * columns + target / rows);
+            }
+        }
+    }
+
+    return result;
+}
+
+#else
+
+bool MoveKernels::hasVectorKernel()
+{
+    return false;
+}
+
+
+KernelResult MoveKernels::moveVectorCells(std::uint8_t *cells, int rows, int columns,
+                                          Direction direction, std::int16_t *targets)
+{
+    return moveCells(cells, rows, columns, direction, targets);
+}
+
+#endif
+
+} // namespace Internal
+} // namespace Game
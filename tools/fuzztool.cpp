@@ -0,0 +1,230 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "boardengine.h"
+#include "movefuzzer.h"
+#include "movekernel.h"
+#include "randomgenerator.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+static const long long DEFAULT_BOARDS_COUNT = 1 << 20;
+static const int DEFAULT_MAX_SIDE = Game::Internal::MoveFuzzer::MAX_VECTOR_SIDE;
+static const int MAX_SIDE = 64;
+static const int BATCH_BOARDS_COUNT = 1 << 12;
+static const char *const DIRECTION_NAMES[] = { "left", "right", "up", "down" };
+
+
+using Game::Internal::Direction;
+using Game::Internal::MoveFuzzer;
+using Game::Internal::MoveKernels;
+using Game::Internal::MoveMismatch;
+using Game::Internal::RandomGenerator;
+using Game::Internal::ThreadPool;
+
+
+static void printCells(const char *title, const std::vector<std::uint8_t> &cells, int rows, int columns)
+{
+    std::fprintf(stderr, "%s\n", title);
+
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            std::fprintf(stderr, " %2d", cells[std::size_t(row * columns + column)]);
+        }
+        std::fprintf(stderr, "\n");
+    }
+}
+
+
+static void printMismatch(const MoveMismatch &mismatch)
+{
+    std::fprintf(stderr, "The %s disagrees with the legacy walk moving a %dx%d board %s\n",
+                 MoveFuzzer::engineName(mismatch.engine), mismatch.rows, mismatch.columns,
+                 DIRECTION_NAMES[int(mismatch.direction)]);
+    std::fprintf(stderr, "Legacy: score %d, merges %d, moved tiles %d\n",
+                 mismatch.expected.score, mismatch.expected.merges, mismatch.expected.moves);
+    std::fprintf(stderr, "Engine: score %d, merges %d, moved tiles %d\n",
+                 mismatch.actual.score, mismatch.actual.merges, mismatch.actual.moves);
+
+    printCells("Exponents before the move:", mismatch.cells, mismatch.rows, mismatch.columns);
+    printCells("Legacy exponents:", mismatch.expectedCells, mismatch.rows, mismatch.columns);
+    printCells("Engine exponents:", mismatch.actualCells, mismatch.rows, mismatch.columns);
+}
+
+
+#ifdef MOVE_FUZZER_LIBFUZZER
+
+// The first two bytes are the board size, the others the exponents of the row-major cells
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    if (size < 2) {
+        return 0;
+    }
+
+    const int rows = 1 + data[0] % DEFAULT_MAX_SIDE;
+    const int columns = 1 + data[1] % DEFAULT_MAX_SIDE;
+
+    std::vector<std::uint8_t> cells(std::size_t(rows * columns), 0);
+    for (std::size_t cell = 0; cell < cells.size() && cell + 2 < size; ++cell) {
+        cells[cell] = std::uint8_t(data[cell + 2] % (MoveFuzzer::MAX_EXPONENT + 1));
+    }
+
+    MoveMismatch mismatch;
+    if (!MoveFuzzer::check(cells.data(), rows, columns, &mismatch)) {
+        printMismatch(mismatch);
+        std::abort();
+    }
+
+    return 0;
+}
+
+#else
+
+struct Options
+{
+    long long boards;
+    int maxSide;
+    int threads;
+    std::uint64_t seed;
+};
+
+
+static void printUsage(const char *program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [options]\n"
+                 "  --boards N      random boards to move in every direction, %lld by default\n"
+                 "  --max-side N    longest board side up to %d, %d by default\n"
+                 "  --seed N        seed of the boards, 0 by default\n"
+                 "  --threads N     threads to move on, all hardware threads by default\n",
+                 program, DEFAULT_BOARDS_COUNT, MAX_SIDE, DEFAULT_MAX_SIDE);
+}
+
+
+static bool parseOptions(int argc, char *argv[], Options &options)
+{
+    options.boards = DEFAULT_BOARDS_COUNT;
+    options.maxSide = DEFAULT_MAX_SIDE;
+    options.threads = 0;
+    options.seed = 0;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+        const char *value = argv[i + 1];
+
+        if ("--boards" == option) {
+            options.boards = std::atoll(value);
+        } else if ("--max-side" == option) {
+            options.maxSide = std::atoi(value);
+        } else if ("--seed" == option) {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if ("--threads" == option) {
+            options.threads = std::atoi(value);
+        } else {
+            return false;
+        }
+    }
+
+    return (1 == argc % 2) && 0 < options.boards && 0 < options.maxSide && options.maxSide <= MAX_SIDE
+            && 0 <= options.threads;
+}
+
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ThreadPool pool(options.threads);
+    const long long batches = (options.boards + BATCH_BOARDS_COUNT - 1) / BATCH_BOARDS_COUNT;
+
+    std::atomic<long long> mismatches(0);
+    std::mutex mismatchMutex;
+    long long firstMismatchBoard = options.boards;
+    MoveMismatch firstMismatch;
+
+    std::printf("Moving %lld boards up to %dx%d on %d threads, vector kernel %s\n", options.boards,
+                options.maxSide, options.maxSide, pool.threads(),
+                MoveKernels::hasVectorKernel() ? "on" : "off");
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Every batch draws its boards from its own stream, so a mismatch is found again with the same seed
+    pool.parallelFor(int(batches), [&](int batch) {
+        RandomGenerator random(options.seed, std::uint64_t(batch));
+        std::vector<std::uint8_t> cells;
+        MoveMismatch mismatch;
+
+        const long long firstBoard = batch * static_cast<long long>(BATCH_BOARDS_COUNT);
+        const long long lastBoard = std::min(options.boards, firstBoard + BATCH_BOARDS_COUNT);
+
+        for (long long board = firstBoard; board < lastBoard; ++board) {
+            int rows = 0;
+            int columns = 0;
+            MoveFuzzer::randomBoard(random, options.maxSide, rows, columns, cells);
+
+            if (MoveFuzzer::check(cells.data(), rows, columns, &mismatch)) {
+                continue;
+            }
+
+            ++mismatches;
+
+            std::lock_guard<std::mutex> lock(mismatchMutex);
+            if (board < firstMismatchBoard) {
+                firstMismatchBoard = board;
+                firstMismatch = mismatch;
+            }
+        }
+    });
+
+    const auto finish = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(finish - start).count();
+    const double moves = 4.0 * options.boards;
+
+    std::printf("%lld boards, %.0f moves in %.2f s: %.1f M moves/min\n", options.boards, moves, seconds,
+                (0.0 < seconds) ? moves * 60.0 / seconds / 1e6 : 0.0);
+
+    if (0 == mismatches) {
+        std::printf("All engines agree with the legacy walk\n");
+        return EXIT_SUCCESS;
+    }
+
+    std::fprintf(stderr, "%lld boards disagree, the first one is board %lld\n", mismatches.load(), firstMismatchBoard);
+    printMismatch(firstMismatch);
+
+    return EXIT_FAILURE;
+}
+
+#endif
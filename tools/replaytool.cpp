@@ -0,0 +1,262 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "boardengine.h"
+#include "replayverifier.h"
+#include "threadpool.h"
+
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static const char *const DATABASE_TYPE = "QSQLITE";
+static const char *const DATABASE_CONNECT_OPTIONS = "QSQLITE_OPEN_READONLY";
+static const char *const CONNECTION_NAME = "replay-%1";
+// Only the first turns with issues of a game are listed, all of them are counted
+static const int REPORTED_TURNS_COUNT = 20;
+static const int ISSUES_COUNT = 7;
+static const int MAX_TILE_EXPONENT = 255;
+
+
+using Game::Internal::BoardEngine;
+using Game::Internal::ReplayIssue;
+using Game::Internal::ReplayIssues;
+using Game::Internal::ReplayTurn;
+using Game::Internal::ReplayVerifier;
+using Game::Internal::ThreadPool;
+
+
+struct DatabaseReport
+{
+    bool ok;
+    std::string error;
+    std::uint64_t turns;
+    std::uint64_t failedTurns;
+    std::array<std::uint64_t, ISSUES_COUNT> issues;
+    std::vector<std::string> reportedTurns;
+};
+
+
+static std::string issuesText(ReplayIssues issues)
+{
+    std::string text;
+
+    for (int issue = 0; issue < ISSUES_COUNT; ++issue) {
+        if (0 != (issues & ReplayVerifier::issueBit(ReplayIssue(issue)))) {
+            text += text.empty() ? "" : ", ";
+            text += ReplayVerifier::issueName(ReplayIssue(issue));
+        }
+    }
+
+    return text;
+}
+
+
+// Reads the tile exponents of the turn from the tiles stream, which is ordered by turn and cell
+static void readTiles(QSqlQuery &tiles, bool &hasTile, ReplayTurn &turn)
+{
+    std::fill(turn.cells.begin(), turn.cells.end(), 0);
+    turn.validTiles = true;
+
+    // Tiles of removed turns are skipped
+    while (hasTile && tiles.value(0).toLongLong() < turn.turnId) {
+        hasTile = tiles.next();
+    }
+
+    for (; hasTile && tiles.value(0).toLongLong() == turn.turnId; hasTile = tiles.next()) {
+        const int cell = tiles.value(1).toInt();
+        const int value = tiles.value(2).toInt();
+        const int exponent = BoardEngine::exponentFromValue(value);
+
+        const bool valid = 0 <= cell && cell < int(turn.cells.size()) && 0 == turn.cells[std::size_t(cell)] &&
+                           0 < exponent && exponent <= MAX_TILE_EXPONENT && value == (1 << exponent);
+        if (!valid) {
+            turn.validTiles = false;
+            continue;
+        }
+
+        turn.cells[std::size_t(cell)] = std::uint8_t(exponent);
+    }
+}
+
+
+// The storage keeps the turns of the last game only, they are streamed with two forward-only queries
+static void verifyGame(QSqlDatabase &database, DatabaseReport &report)
+{
+    QSqlQuery game(database);
+    if (!game.exec(QLatin1Literal("SELECT rows, columns, seed FROM games ORDER BY game_id DESC LIMIT 1")) || !game.first()) {
+        report.error = "no game: " + game.lastError().text().toStdString();
+        return;
+    }
+
+    const int rows = game.value(0).toInt();
+    const int columns = game.value(1).toInt();
+    if (rows <= 0 || columns <= 0) {
+        report.error = "bad board size";
+        return;
+    }
+
+    ReplayVerifier verifier(rows, columns, std::uint64_t(game.value(2).toLongLong()));
+
+    QSqlQuery turns(database);
+    turns.setForwardOnly(true);
+    QSqlQuery tiles(database);
+    tiles.setForwardOnly(true);
+
+    if (!turns.exec(QLatin1Literal("SELECT turn_id, parent_turn_id, move_direction, score FROM turns ORDER BY turn_id")) ||
+            !tiles.exec(QLatin1Literal("SELECT turn_id, cell_index, tile_value FROM tiles ORDER BY turn_id, cell_index"))) {
+        report.error = "failed to read turns: " + turns.lastError().text().toStdString() + tiles.lastError().text().toStdString();
+        return;
+    }
+
+    ReplayTurn turn;
+    turn.cells.resize(std::size_t(rows * columns));
+    bool hasTile = tiles.next();
+
+    while (turns.next()) {
+        turn.turnId = turns.value(0).toLongLong();
+        turn.parentTurnId = turns.value(1).toLongLong();
+        turn.moveDirection = turns.value(2).toInt();
+        turn.score = turns.value(3).toLongLong();
+        readTiles(tiles, hasTile, turn);
+
+        const ReplayIssues issues = verifier.verify(turn);
+        if (0 == issues) {
+            continue;
+        }
+
+        ++report.failedTurns;
+        for (int issue = 0; issue < ISSUES_COUNT; ++issue) {
+            if (0 != (issues & ReplayVerifier::issueBit(ReplayIssue(issue)))) {
+                ++report.issues[std::size_t(issue)];
+            }
+        }
+
+        if (int(report.reportedTurns.size()) < REPORTED_TURNS_COUNT) {
+            report.reportedTurns.push_back("turn " + std::to_string(turn.turnId) + ": " + issuesText(issues));
+        }
+    }
+
+    report.turns = verifier.turns();
+    report.ok = true;
+}
+
+
+static DatabaseReport verifyDatabase(const QString &fileName, int index)
+{
+    DatabaseReport report;
+    report.ok = false;
+    report.turns = 0;
+    report.failedTurns = 0;
+    report.issues.fill(0);
+
+    // Every thread needs its own connection
+    const QString &connectionName = QString(QLatin1Literal(CONNECTION_NAME)).arg(index);
+
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase(QLatin1Literal(DATABASE_TYPE), connectionName);
+        database.setDatabaseName(fileName);
+        database.setConnectOptions(QLatin1Literal(DATABASE_CONNECT_OPTIONS));
+
+        if (database.open()) {
+            verifyGame(database, report);
+            database.close();
+        } else {
+            report.error = "failed to open: " + database.lastError().text().toStdString();
+        }
+    }
+
+    QSqlDatabase::removeDatabase(connectionName);
+
+    return report;
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    const QStringList &fileNames = QCoreApplication::arguments().mid(1);
+
+    if (fileNames.isEmpty()) {
+        std::fprintf(stderr, "Usage: %s DATABASE...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<DatabaseReport> reports(static_cast<std::size_t>(fileNames.size()));
+    ThreadPool pool;
+
+    const auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(fileNames.size(), [&](int index) {
+        reports[std::size_t(index)] = verifyDatabase(fileNames.at(index), index);
+    });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::uint64_t turns = 0;
+    std::uint64_t failedTurns = 0;
+    std::array<std::uint64_t, ISSUES_COUNT> issues;
+    issues.fill(0);
+    int failedDatabases = 0;
+
+    for (int index = 0; index < fileNames.size(); ++index) {
+        const DatabaseReport &report = reports[std::size_t(index)];
+        const std::string &fileName = fileNames.at(index).toStdString();
+
+        if (!report.ok) {
+            std::printf("%s: %s\n", fileName.c_str(), report.error.c_str());
+            ++failedDatabases;
+            continue;
+        }
+
+        for (const std::string &turn : report.reportedTurns) {
+            std::printf("%s: %s\n", fileName.c_str(), turn.c_str());
+        }
+
+        turns += report.turns;
+        failedTurns += report.failedTurns;
+        for (std::size_t issue = 0; issue < issues.size(); ++issue) {
+            issues[issue] += report.issues[issue];
+        }
+    }
+
+    std::printf("%d databases, %llu turns in %.2f s (%.0f turns/s), %llu turns with issues, %d databases unreadable\n",
+                fileNames.size(), static_cast<unsigned long long>(turns), seconds, 0.0 < seconds ? turns / seconds : 0.0,
+                static_cast<unsigned long long>(failedTurns), failedDatabases);
+
+    for (int issue = 0; issue < ISSUES_COUNT; ++issue) {
+        if (0 != issues[std::size_t(issue)]) {
+            std::printf("%16s %llu\n", ReplayVerifier::issueName(ReplayIssue(issue)),
+                        static_cast<unsigned long long>(issues[std::size_t(issue)]));
+        }
+    }
+
+    return (0 == failedTurns && 0 == failedDatabases) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,366 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "boardengine.h"
+#include "simulationshard.h"
+#include "simulator.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+static const int DEFAULT_GAMES_COUNT = 1000;
+static const double SCORE_PERCENTILES[] = { 1, 10, 25, 50, 75, 90, 99, 100 };
+static const char *const POLICY_NAMES[] = { "random", "greedy", "expectimax" };
+
+
+using Game::Internal::BoardEngine;
+using Game::Internal::SimulationPolicy;
+using Game::Internal::SimulationShard;
+using Game::Internal::SimulationShards;
+using Game::Internal::SimulationStatistics;
+using Game::Internal::Simulator;
+using Game::Internal::ThreadPool;
+
+
+struct Options
+{
+    int games;
+    int threads;
+    int depth;
+    int shards;
+    std::uint64_t firstGame;
+    std::uint64_t seed;
+    SimulationPolicy policy;
+    std::string output;
+};
+
+
+static void printUsage(const char *program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [options]\n"
+                 "       %s --merge OUTPUT SHARD...\n"
+                 "  --games N       games to play, %d by default\n"
+                 "  --first-game N  index of the first game, 0 by default\n"
+                 "  --policy NAME   random, greedy or expectimax, greedy by default\n"
+                 "  --depth N       expectimax depth, %d by default\n"
+                 "  --seed N        seed of the spawns, 0 by default\n"
+                 "  --threads N     threads to play on, of every shard with --shards,\n"
+                 "                  all hardware threads by default\n"
+                 "  --shards N      plays the games in N processes, needs --output\n"
+                 "  --output FILE   writes the results to FILE, the ones of shard K to FILE.K\n",
+                 program, program, DEFAULT_GAMES_COUNT, Simulator::DEFAULT_DEPTH);
+}
+
+
+static bool parsePolicy(const char *name, SimulationPolicy &policy)
+{
+    for (int index = 0; index < int(sizeof(POLICY_NAMES) / sizeof(POLICY_NAMES[0])); ++index) {
+        if (std::string(POLICY_NAMES[index]) == name) {
+            policy = SimulationPolicy(index);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+static bool parseOptions(int argc, char *argv[], Options &options)
+{
+    options.games = DEFAULT_GAMES_COUNT;
+    options.threads = 0;
+    options.depth = Simulator::DEFAULT_DEPTH;
+    options.shards = 0;
+    options.firstGame = 0;
+    options.seed = 0;
+    options.policy = SimulationPolicy::Greedy;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+        const char *value = argv[i + 1];
+
+        if ("--games" == option) {
+            options.games = std::atoi(value);
+        } else if ("--first-game" == option) {
+            options.firstGame = std::strtoull(value, nullptr, 10);
+        } else if ("--policy" == option) {
+            if (!parsePolicy(value, options.policy)) {
+                return false;
+            }
+        } else if ("--depth" == option) {
+            options.depth = std::atoi(value);
+        } else if ("--seed" == option) {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if ("--threads" == option) {
+            options.threads = std::atoi(value);
+        } else if ("--shards" == option) {
+            options.shards = std::atoi(value);
+        } else if ("--output" == option) {
+            options.output = value;
+        } else {
+            return false;
+        }
+    }
+
+    return (1 == argc % 2) && 0 < options.games && 0 < options.depth && 0 <= options.threads
+            && 0 <= options.shards && options.shards <= options.games
+            && (0 == options.shards || !options.output.empty());
+}
+
+
+static void printStatistics(const SimulationStatistics &statistics)
+{
+    std::printf("%zu games in %.2f s: %.1f games/s, %.0f moves/s\n", statistics.games.size(), statistics.seconds,
+                statistics.gamesPerSecond(), statistics.movesPerSecond());
+    std::printf("Mean score %.0f, win rate %.2f%%\n", statistics.meanScore(), 100.0 * statistics.winRate());
+
+    std::printf("Score percentiles:");
+    for (const double percentile : SCORE_PERCENTILES) {
+        std::printf(" p%g %u", percentile, statistics.scorePercentile(percentile));
+    }
+    std::printf("\n");
+
+    // Every tile count is followed by the share of games which reached at least that tile
+    const auto maxTiles = statistics.maxTiles();
+    std::uint64_t reached = statistics.games.size();
+
+    std::printf("Max tiles:\n");
+    for (int exponent = 0; exponent <= BoardEngine::MAX_EXPONENT; ++exponent) {
+        const std::uint64_t count = maxTiles[std::size_t(exponent)];
+        if (0 != count) {
+            std::printf("%8d %10llu %7.2f%% %7.2f%%\n", BoardEngine::valueFromExponent(exponent),
+                        static_cast<unsigned long long>(count), 100.0 * count / statistics.games.size(),
+                        100.0 * reached / statistics.games.size());
+        }
+        reached -= count;
+    }
+}
+
+
+static bool saveShard(const Options &options, const SimulationShard &shard)
+{
+    if (options.output.empty() || SimulationShards::save(options.output, shard)) {
+        return true;
+    }
+
+    std::fprintf(stderr, "Can't write %s\n", options.output.c_str());
+    return false;
+}
+
+
+static int mergeShards(int argc, char *argv[])
+{
+    std::vector<SimulationShard> shards(std::size_t(argc - 3));
+
+    for (int i = 3; i < argc; ++i) {
+        if (!SimulationShards::load(argv[i], shards[std::size_t(i - 3)])) {
+            std::fprintf(stderr, "Can't read the results of %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    SimulationShard merged;
+    if (!SimulationShards::merge(shards, merged)) {
+        std::fprintf(stderr, "The shards are of different runs or leave games out\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!SimulationShards::save(argv[2], merged)) {
+        std::fprintf(stderr, "Can't write %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    printStatistics(merged.statistics);
+
+    return EXIT_SUCCESS;
+}
+
+
+#ifdef __linux__
+
+// Runs the shard on a copy of this program, whose output but the errors is dropped
+static pid_t startShard(const Options &options, int games, std::uint64_t firstGame, int threads,
+                        const std::string &output)
+{
+    const std::vector<std::string> arguments = {
+        "2048-sim",
+        "--games", std::to_string(games),
+        "--first-game", std::to_string(firstGame),
+        "--policy", POLICY_NAMES[int(options.policy)],
+        "--depth", std::to_string(options.depth),
+        "--seed", std::to_string(options.seed),
+        "--threads", std::to_string(threads),
+        "--output", output
+    };
+
+    std::vector<char *> argv;
+    for (const std::string &argument : arguments) {
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    const pid_t pid = fork();
+    if (0 != pid) {
+        return pid;
+    }
+
+    const int null = open("/dev/null", O_WRONLY);
+    if (0 <= null) {
+        dup2(null, STDOUT_FILENO);
+        close(null);
+    }
+
+    execv("/proc/self/exe", argv.data());
+    std::perror("Can't start a shard");
+    _exit(EXIT_FAILURE);
+}
+
+
+static int runShards(const Options &options)
+{
+    const int hardwareThreads = std::max(1, int(std::thread::hardware_concurrency()));
+    const int threads = (0 != options.threads) ? options.threads : std::max(1, hardwareThreads / options.shards);
+
+    std::vector<pid_t> processes;
+    std::vector<std::string> outputs;
+    std::uint64_t firstGame = options.firstGame;
+    bool ok = true;
+
+    std::printf("Playing %d shards on %d threads each\n", options.shards, threads);
+    std::fflush(stdout);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // The first shards take one game more when they don't split evenly
+    for (int shard = 0; shard < options.shards; ++shard) {
+        const int games = options.games / options.shards + (shard < options.games % options.shards ? 1 : 0);
+        outputs.push_back(options.output + "." + std::to_string(shard));
+
+        const pid_t pid = startShard(options, games, firstGame, threads, outputs.back());
+        if (pid < 0) {
+            std::perror("Can't fork a shard");
+            ok = false;
+            break;
+        }
+
+        processes.push_back(pid);
+        firstGame += std::uint64_t(games);
+    }
+
+    for (std::size_t shard = 0; shard < processes.size(); ++shard) {
+        int status = 0;
+        if (processes[shard] != waitpid(processes[shard], &status, 0) || !WIFEXITED(status)
+                || EXIT_SUCCESS != WEXITSTATUS(status)) {
+            std::fprintf(stderr, "Shard %zu failed\n", shard);
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        return EXIT_FAILURE;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<SimulationShard> shards(outputs.size());
+    for (std::size_t shard = 0; shard < outputs.size(); ++shard) {
+        if (!SimulationShards::load(outputs[shard], shards[shard])) {
+            std::fprintf(stderr, "Can't read the results of %s\n", outputs[shard].c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    SimulationShard merged;
+    if (!SimulationShards::merge(shards, merged)) {
+        return EXIT_FAILURE;
+    }
+
+    // The run took the time measured here, which includes starting the shards
+    merged.statistics.seconds = seconds;
+
+    if (!saveShard(options, merged)) {
+        return EXIT_FAILURE;
+    }
+
+    printStatistics(merged.statistics);
+
+    return EXIT_SUCCESS;
+}
+
+#else
+
+static int runShards(const Options &)
+{
+    std::fprintf(stderr, "Shards need fork and exec, which this platform doesn't have\n");
+    return EXIT_FAILURE;
+}
+
+#endif
+
+
+int main(int argc, char *argv[])
+{
+    if (1 < argc && std::string("--merge") == argv[1]) {
+        if (argc < 4) {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        return mergeShards(argc, argv);
+    }
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (0 < options.shards) {
+        return runShards(options);
+    }
+
+    ThreadPool pool(options.threads);
+    Simulator simulator(&pool, options.seed);
+    simulator.setPolicy(options.policy);
+    simulator.setDepth(options.depth);
+
+    std::printf("Playing on %d threads\n", pool.threads());
+
+    const SimulationShard shard = { options.policy, options.depth, options.seed, options.firstGame,
+                                    simulator.run(options.games, options.firstGame) };
+    printStatistics(shard.statistics);
+
+    return saveShard(options, shard) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,133 @@
+/***************************************************************************
+**
+** Copyright (C) 2018 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the 2048 Game.
+**
+** The 2048 Game is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The 2048 Game is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the 2048 Game.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "boardengine.h"
+#include "tablebase.h"
+#include "tablebasegenerator.h"
+#include "threadpool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// About a million states of a large tablebase are looked up in the written file
+static const std::uint64_t VERIFIED_STATES_COUNT = 1 << 20;
+
+
+using Game::Internal::Board;
+using Game::Internal::BoardEngine;
+using Game::Internal::Tablebase;
+using Game::Internal::TablebaseEntry;
+using Game::Internal::TablebaseGenerator;
+using Game::Internal::TablebaseLayer;
+using Game::Internal::ThreadPool;
+
+
+static bool readFile(const char *fileName, std::vector<unsigned char> &data)
+{
+    std::FILE *file = std::fopen(fileName, "rb");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = (0 == std::fseek(file, 0, SEEK_END));
+    const long size = ok ? std::ftell(file) : -1;
+    ok = ok && (0 <= size) && (0 == std::fseek(file, 0, SEEK_SET));
+
+    if (ok) {
+        data.resize(std::size_t(size));
+        ok = (data.size() == std::fread(data.data(), 1, data.size(), file));
+    }
+
+    std::fclose(file);
+    return ok;
+}
+
+
+static bool verify(const TablebaseGenerator &generator, const Tablebase &tablebase)
+{
+    const std::uint64_t step = std::max<std::uint64_t>(1, generator.statesCount() / VERIFIED_STATES_COUNT);
+    std::uint64_t index = 0;
+
+    for (const TablebaseLayer &layer : generator.layers()) {
+        for (std::size_t i = 0; i < layer.boards.size(); ++i, ++index) {
+            if (0 != index % step) {
+                continue;
+            }
+
+            TablebaseEntry entry;
+            if (!tablebase.lookup(layer.boards[i], entry) || layer.values[i] != entry.expectedScore) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+    if (4 != argc) {
+        std::fprintf(stderr, "Usage: %s ROWS COLUMNS FILE\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const int rows = std::atoi(argv[1]);
+    const int columns = std::atoi(argv[2]);
+    const char *fileName = argv[3];
+
+    if (rows < 1 || BoardEngine::ROWS < rows || columns < 1 || BoardEngine::COLUMNS < columns || rows * columns < 2) {
+        std::fprintf(stderr, "The board has to fit 4x4 and hold the start tiles\n");
+        return EXIT_FAILURE;
+    }
+
+    ThreadPool pool;
+    TablebaseGenerator generator(rows, columns, &pool);
+
+    const auto start = std::chrono::steady_clock::now();
+    generator.generate();
+    const auto finish = std::chrono::steady_clock::now();
+
+    std::printf("%dx%d board: %llu states in %zu layers, %.1f s\n", rows, columns,
+                static_cast<unsigned long long>(generator.statesCount()), generator.layers().size(),
+                std::chrono::duration<double>(finish - start).count());
+    std::printf("Expected score from the start: %.2f\n", generator.startScore());
+
+    if (!generator.save(fileName)) {
+        std::fprintf(stderr, "Failed to write %s\n", fileName);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<unsigned char> data;
+    Tablebase tablebase;
+
+    if (!readFile(fileName, data) || !tablebase.attach(data.data(), data.size()) || !verify(generator, tablebase)) {
+        std::fprintf(stderr, "Failed to verify %s\n", fileName);
+        return EXIT_FAILURE;
+    }
+
+    std::printf("Wrote %s, %.2f MB\n", fileName, data.size() / double(1 << 20));
+
+    return EXIT_SUCCESS;
+}